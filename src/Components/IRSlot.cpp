@@ -298,6 +298,7 @@ void IRSlot::comboBoxChanged(juce::ComboBox* comboBoxThatHasChanged)
 
                 // Update display data
                 displayData.irName = selectedIR.name;
+                displayData.irFile = selectedIR.file;
                 displayData.hasValidIR = true;
                 setActive(true);
                 repaint();
@@ -337,15 +338,68 @@ void IRSlot::buttonClicked(juce::Button* button)
 //==============================================================================
 void IRSlot::updateFolderList(const std::vector<IRManager::FolderInfo>& folders)
 {
+    // Called again as folders are populated, so keep the current selection
+    const auto previousFolders = std::move(availableFolders);
+    const auto selectedIndex = hasFolderSelected() ? folderComboBox->getSelectedItemIndex() - 1 : -1;
+    const auto* selected = selectedIndex >= 0 ? &previousFolders[static_cast<size_t>(selectedIndex)] : nullptr;
     availableFolders = folders;
-    
-    folderComboBox->clear();
+
+    // Usually only some folder's contents arrived: the folder menu stays as it is, and the IR
+    // menu is rebuilt only if it was the selected folder's
+    const bool sameFolders = std::equal(folders.begin(), folders.end(), previousFolders.begin(), previousFolders.end(),
+        [](const IRManager::FolderInfo& a, const IRManager::FolderInfo& b) { return a.directory == b.directory; });
+
+    if (sameFolders)
+    {
+        if (selected != nullptr && !hasSameContents(folders[static_cast<size_t>(selectedIndex)], *selected))
+            updateIRComboBox();
+
+        return;
+    }
+
+    folderComboBox->clear(juce::dontSendNotification);
     folderComboBox->addItem("Select Folder...", -1);
     
+    bool reselected = selected == nullptr;
+    bool contentsChanged = false;
     for (int i = 0; i < static_cast<int>(folders.size()); ++i)
     {
         folderComboBox->addItem(folders[i].name, i + 1);
+
+        if (!reselected && folders[i].name.equalsIgnoreCase(selected->name))
+        {
+            folderComboBox->setSelectedItemIndex(i + 1, juce::dontSendNotification);
+            reselected = true;
+            contentsChanged = !hasSameContents(folders[i], *selected);
+        }
     }
+
+    // The selected folder is gone (new IR directory) or its contents just arrived (or were
+    // dropped by a rescan): rebuild its IR list
+    if (!reselected || contentsChanged)
+        updateIRComboBox();
+}
+
+bool IRSlot::hasSameContents(const IRManager::FolderInfo& a, const IRManager::FolderInfo& b)
+{
+    // A rescan can repopulate a folder between two updates, so the files themselves are compared
+    if (a.isPopulated != b.isPopulated || a.directory != b.directory
+        || a.irFiles.size() != b.irFiles.size() || a.subfolders.size() != b.subfolders.size())
+        return false;
+
+    for (size_t i = 0; i < a.irFiles.size(); ++i)
+    {
+        if (a.irFiles[i].file != b.irFiles[i].file)
+            return false;
+    }
+
+    for (size_t i = 0; i < a.subfolders.size(); ++i)
+    {
+        if (!hasSameContents(a.subfolders[i], b.subfolders[i]))
+            return false;
+    }
+
+    return true;
 }
 
 void IRSlot::setLoadedIR(const juce::String& folderName, const juce::String& irName)
@@ -364,12 +418,13 @@ void IRSlot::syncToLoadedFile(const juce::File& file)
 
     auto folder = file.getParentDirectory().getFileName();
     auto name = file.getFileNameWithoutExtension();
+    displayData.irFile = file;
 
-    // Select folder in combo
+    // Select the top-level folder the file is somewhere inside
     int folderIndex = -1;
     for (int i = 0; i < static_cast<int>(availableFolders.size()); ++i)
     {
-        if (availableFolders[i].name.equalsIgnoreCase(folder))
+        if (file.isAChildOf(availableFolders[i].directory))
         {
             folderIndex = i;
             break;
@@ -378,38 +433,19 @@ void IRSlot::syncToLoadedFile(const juce::File& file)
     if (folderIndex >= 0)
     {
         folderComboBox->setSelectedItemIndex(folderIndex + 1, juce::dontSendNotification); // +1 for "Select Folder..."
-        updateIRComboBox();
 
-        // Find IR name in list and select
-        int irIndex = -1;
-        for (int i = 0; i < static_cast<int>(displayData.availableIRs.size()); ++i)
-        {
-            if (displayData.availableIRs[i].name.equalsIgnoreCase(name))
-            {
-                irIndex = i;
-                break;
-            }
-        }
-        if (irIndex >= 0)
-        {
-            irComboBox->setSelectedItemIndex(irIndex + 1, juce::dontSendNotification); // +1 for "Select IR..."
-            setLoadedIR(folder, name);
-        }
-        else
-        {
-            setLoadedIR(folder, name);
-        }
-    }
-    else
-    {
-        setLoadedIR(folder, name);
+        // Selects the file now, or once the folder's contents arrive
+        updateIRComboBox();
     }
+
+    setLoadedIR(folder, name);
 }
 
 void IRSlot::clearIR()
 {
     displayData.folderName.clear();
     displayData.irName.clear();
+    displayData.irFile = juce::File();
     displayData.hasValidIR = false;
     displayData.availableIRs.clear();
     
@@ -449,7 +485,6 @@ void IRSlot::updateIRComboBox()
     irComboBox->clear();
     irComboBox->setEnabled(false);
     displayData.availableIRs.clear();
-    preloadedIRBuffers.clear(); // Clear any existing preloaded buffers
     
     auto selectedFolderIndex = folderComboBox->getSelectedItemIndex() - 1; // Adjust for "Select Folder..." item
     
@@ -458,26 +493,46 @@ void IRSlot::updateIRComboBox()
         // Add explicit 'None' first
         irComboBox->addItem("None", 1);
         
-        // Get IRs from the selected folder
+        // Get IRs from the selected folder; nothing is decoded here, the background
+        // loader reads an IR only once it is actually selected
         const auto& folder = availableFolders[selectedFolderIndex];
-        displayData.availableIRs = folder.irFiles;
-        
-        DBG("Pre-loading all IRs in folder: " << folder.name);
-        
-        // Populate the combo box with proper IDs AND pre-load buffers
-        for (int i = 0; i < static_cast<int>(folder.irFiles.size()); ++i)
-        {
-            irComboBox->addItem(folder.irFiles[i].name, i + 2); // IDs start from 2 (1 reserved for 'None')
-            
-            // Pre-load this IR buffer for instant navigation
-            preloadIRBuffer(folder.irFiles[i].file);
-        }
-        
-        DBG("Pre-loaded " << preloadedIRBuffers.size() << " IR buffers for instant navigation");
+        addFolderToMenu(*irComboBox->getRootMenu(), folder);
+
+        // Folders are read on first use; updateFolderList() brings us back here when it's done
+        if (!folder.isPopulated && onFolderNeeded)
+            onFolderNeeded(folder.directory);
         
-        irComboBox->setEnabled(true);
+        irComboBox->setEnabled(folder.isPopulated);
         irComboBox->setSelectedId(1, juce::dontSendNotification);
         displayData.folderName = folder.name;
+
+        // Match the file itself: the same IR name often appears in several subfolders
+        for (int i = 0; i < static_cast<int>(displayData.availableIRs.size()); ++i)
+        {
+            if (displayData.availableIRs[i].file == displayData.irFile)
+            {
+                irComboBox->setSelectedId(i + 2, juce::dontSendNotification);
+                break;
+            }
+        }
+    }
+}
+
+void IRSlot::addFolderToMenu(juce::PopupMenu& menu, const IRManager::FolderInfo& folder)
+{
+    // Subfolders become sub-menus. Item IDs follow availableIRs, so prev/next navigation
+    // walks the whole tree in the order the menu shows it.
+    for (const auto& subfolder : folder.subfolders)
+    {
+        juce::PopupMenu subMenu;
+        addFolderToMenu(subMenu, subfolder);
+        menu.addSubMenu(subfolder.name, subMenu);
+    }
+
+    for (const auto& irInfo : folder.irFiles)
+    {
+        displayData.availableIRs.push_back(irInfo);
+        menu.addItem(static_cast<int>(displayData.availableIRs.size()) + 1, irInfo.name); // IDs start from 2 (1 reserved for 'None')
     }
 }
 
@@ -636,98 +691,40 @@ void IRSlot::navigateToIR(int direction)
     // Update ComboBox selection WITHOUT notification first
     irComboBox->setSelectedId(newIndex + 2, juce::dontSendNotification);
     
-    DBG("Using pre-loaded IR buffer for instant navigation...");
-    
-    // Use pre-loaded buffer for instant navigation (no disk I/O!)
-    usePreloadedIR(newIndex);
+    // Only queues a request: rapid clicks are coalesced by the background loader
+    selectIR(newIndex);
     
     DBG("ComboBox final state - ID: " << irComboBox->getSelectedId() << ", ItemIndex: " << irComboBox->getSelectedItemIndex());
     DBG("===== NAVIGATE_TO_IR END =====");
 }
 
 //==============================================================================
-void IRSlot::preloadIRBuffer(const juce::File& irFile)
-{
-    DBG("Pre-loading IR buffer: " << irFile.getFileName());
-    
-    // Create audio format manager
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-    
-    // Create reader for the IR file
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(irFile));
-    
-    if (reader == nullptr)
-    {
-        DBG("Failed to create reader for IR file: " << irFile.getFullPathName());
-        return;
-    }
-    
-    // Create buffer and read the IR data
-    auto buffer = std::make_unique<juce::AudioBuffer<float>>();
-    int numChannels = static_cast<int>(reader->numChannels);
-    int lengthInSamples = static_cast<int>(reader->lengthInSamples);
-    
-    buffer->setSize(numChannels, lengthInSamples, false, true, true);
-    
-    if (reader->read(buffer.get(), 0, lengthInSamples, 0, true, true))
-    {
-        preloadedIRBuffers.push_back(std::move(buffer));
-        DBG("Successfully pre-loaded IR: " << irFile.getFileName() << " (" << numChannels << " channels, " << lengthInSamples << " samples)");
-    }
-    else
-    {
-        DBG("Failed to read IR data from: " << irFile.getFullPathName());
-    }
-}
-
-void IRSlot::usePreloadedIR(int irIndex)
+void IRSlot::selectIR(int irIndex)
 {
-    DBG("===== USE_PRELOADED_IR START =====");
-    DBG("Using pre-loaded IR at index: " << irIndex);
-    
-    if (irIndex < 0 || irIndex >= static_cast<int>(preloadedIRBuffers.size()))
-    {
-        DBG("ERROR: Invalid preloaded IR index: " << irIndex << " (available: " << preloadedIRBuffers.size() << ")");
-        return;
-    }
-    
-    if (irIndex >= static_cast<int>(displayData.availableIRs.size()))
+    if (irIndex < 0 || irIndex >= static_cast<int>(displayData.availableIRs.size()))
     {
         DBG("ERROR: IR index out of bounds for availableIRs: " << irIndex);
         return;
     }
     
-    auto& buffer = *preloadedIRBuffers[irIndex];
     const auto& irInfo = displayData.availableIRs[irIndex];
     
-    DBG("Pre-loaded buffer: " << buffer.getNumChannels() << " channels, " << buffer.getNumSamples() << " samples");
-    
-    // Directly load the pre-loaded buffer into the convolution engine via callback
     if (onIRSelected)
     {
-        // We'll use the existing IR loading infrastructure but with pre-loaded data
-        // For now, we still need to use the file path for the callback
-        const auto& selectedIR = displayData.availableIRs[irIndex];
-        DBG("Using existing callback with file: " << selectedIR.file.getFullPathName());
-        onIRSelected(slotIndex, selectedIR.file);
-        
-        DBG("Successfully triggered IR loading via callback");
+        DBG("Requesting IR via callback: " << irInfo.file.getFullPathName());
+        onIRSelected(slotIndex, irInfo.file);
         
         // Update display data
         displayData.irName = irInfo.name;
+        displayData.irFile = irInfo.file;
         displayData.hasValidIR = true;
         setActive(true);
         repaint();
-        
-        DBG("UI updated for pre-loaded IR: " << irInfo.name);
     }
     else
     {
         DBG("ERROR: No onIRSelected callback available");
     }
-    
-    DBG("===== USE_PRELOADED_IR END =====");
 }
 
 
@@ -9,7 +9,7 @@
  * Individual IR Slot Component for The King's Cab
  * 
  * Features:
- * - Folder dropdown with IR selection
+ * - Folder dropdown with IR selection; subfolders appear as sub-menus
  * - Volume, solo, mute, phase controls
  * - Premium 3D styling to match cabinet aesthetic
  * - Real-time waveform display
@@ -44,11 +44,13 @@ public:
     void setLoadedIR(const juce::String& folderName, const juce::String& irName);
     void clearIR();
     void syncToLoadedFile(const juce::File& file);
+    bool hasFolderSelected() const { return folderComboBox->getSelectedItemIndex() > 0; }
 
     //==============================================================================
     // Callbacks for parent component
     std::function<void(int, const juce::File&)> onIRSelected;
     std::function<void(int)> onIRCleared;
+    std::function<void(const juce::File&)> onFolderNeeded; // a folder shown for the first time
 
     //==============================================================================
     // Visual state
@@ -89,16 +91,14 @@ private:
     {
         juce::String folderName;
         juce::String irName;
-        std::vector<struct IRManager::IRInfo> availableIRs;
+        juce::File irFile;
+        std::vector<struct IRManager::IRInfo> availableIRs; // whole folder tree, in menu order
         bool hasValidIR = false;
     };
     IRDisplayData displayData;
     
     // Available folders from IR Manager
     std::vector<IRManager::FolderInfo> availableFolders;
-    
-    // Pre-loaded IR buffers for instant navigation
-    std::vector<std::unique_ptr<juce::AudioBuffer<float>>> preloadedIRBuffers;
 
     //==============================================================================
     // Look and feel
@@ -108,9 +108,10 @@ private:
     // Helper methods
     void setupComponents();
     void updateIRComboBox();
+    void addFolderToMenu(juce::PopupMenu& menu, const IRManager::FolderInfo& folder); // Appends to availableIRs
+    static bool hasSameContents(const IRManager::FolderInfo& a, const IRManager::FolderInfo& b);
     void navigateToIR(int direction); // Navigate through IRs in current folder (-1 = prev, +1 = next)
-    void preloadIRBuffer(const juce::File& irFile); // Pre-load IR buffer for instant navigation
-    void usePreloadedIR(int irIndex); // Use pre-loaded IR buffer instead of loading from disk
+    void selectIR(int irIndex); // Request the IR at this index of the current folder
     juce::String getParameterPrefix() const;
     void drawSlotFrame(juce::Graphics& g, const juce::Rectangle<int>& bounds);
     void drawIRDisplay(juce::Graphics& g, const juce::Rectangle<int>& bounds);
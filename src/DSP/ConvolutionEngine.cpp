@@ -1,41 +1,115 @@
 #include "ConvolutionEngine.h"
 
 //==============================================================================
-ConvolutionEngine::ConvolutionEngine(int numSlots, int maxIRLength)
+ConvolutionEngine::ConvolutionEngine(int numSlots, int maxIRLengthToUse)
+    : slotPool(numSlots, [this](int slotIndex)
+               {
+                   // Pool tasks only touch their own slot: the input was staged in its scratch
+                   processSlot(slotIndex, {}, irSlots[static_cast<size_t>(slotIndex)]->queuedSamples, true);
+               }),
+      maxIRLength(maxIRLengthToUse)
 {
-    juce::ignoreUnused(maxIRLength); // For future zero-latency mode implementation
-    
-    // Initialize IR slots
+    // Initialize IR slots (each one owns a bit in the routing masks)
+    jassert(numSlots <= kRoutingMaskBits);
     irSlots.reserve(numSlots);
     for (int i = 0; i < numSlots; ++i)
     {
         irSlots.push_back(std::make_unique<IRSlot>());
         irSlots[i]->convolution = std::make_unique<juce::dsp::Convolution>();
+
+        for (auto& releaseConvolver : irSlots[i]->releaseConvolvers)
+            releaseConvolver = std::make_unique<PartitionedConvolver>();
     }
+    slotWeights.assign(static_cast<size_t>(numSlots * 2 + 1), 0.0f);
+    crossfadeSamples = juce::roundToInt(currentSampleRate * kIRCrossfadeMs / 1000.0);
+    observedWeights.assign(static_cast<size_t>(numSlots), 0.0f);
+    requestedWeights = std::vector<std::atomic<float>>(static_cast<size_t>(numSlots));
+    requestedGenerations = std::vector<std::atomic<juce::uint32>>(static_cast<size_t>(numSlots));
+    retiredObjects.resize(static_cast<size_t>(kRetirementQueueSize));
 
     // Initialize master smoothers
     masterGainSmoother.setTargetValue(1.0f);
     masterMixSmoother.setTargetValue(1.0f);
+
+    // Allocate the convolver for the full IR length now, so prepare() only has to
+    // reset it unless the layout or channel count changes. With more than one core
+    // the late tail partitions run on the convolver's worker thread. The second
+    // convolver is only prepared once the host first renders offline.
+    sharedConvolvers[0].setUseBackgroundThread(juce::SystemStats::getNumCpus() > 1);
+    sharedConvolvers[0].prepare(currentBlockSize, numChannels, maxIRLength, numSlots * 2 + 1,
+                                getLayoutForMode(processingMode.load(), false));
+
+    // Release convolvers are sized to each IR as it's loaded
+    for (auto& slot : irSlots)
+        slot->releaseConvolvers[0]->prepare(currentBlockSize, numChannels, 1, 2,
+                                            getLayoutForMode(processingMode.load(), false));
+
+    compositeBuilder.startThread();
+    reclaimer.startThread();
 }
 
 ConvolutionEngine::~ConvolutionEngine()
 {
+    slotPool.stop();
+
+    // Both threads sleep until signalled
+    compositeBuilder.signalThreadShouldExit();
+    builderSignal.signal();
+    compositeBuilder.stopThread(2000);
+
+    reclaimer.signalThreadShouldExit();
+    reclaimSignal.signal();
+    reclaimer.stopThread(2000);
+
+    // The tail workers may still be reading a kernel owned below
+    for (auto& convolver : sharedConvolvers)
+        convolver.stopBackgroundThread();
 }
 
 //==============================================================================
 void ConvolutionEngine::prepare(const juce::dsp::ProcessSpec& spec)
 {
+    // A load in progress reads the format below to build its convolution
+    const juce::ScopedLock prepareLock(loadLock);
+
+    // A slot task that overran the last block may still be running
+    slotPool.waitForRunningTasks();
+    overrunSlots = 0;
+
     currentSampleRate = spec.sampleRate;
     currentBlockSize = static_cast<int>(spec.maximumBlockSize);
     numChannels = static_cast<int>(spec.numChannels);
 
-    // Prepare all convolution processors
+    crossfadeSamples = juce::roundToInt(currentSampleRate * kIRCrossfadeMs / 1000.0);
+
+    // Prepare all convolution processors, including any still waiting to be swapped in
     for (auto& slot : irSlots)
     {
         slot->convolution->prepare(spec);
-        
+
+        if (slot->fadingConvolution != nullptr)
+            slot->fadingConvolution->prepare(spec);
+
+        {
+            const juce::SpinLock::ScopedLockType lock(kernelLock);
+            if (slot->pendingConvolution != nullptr)
+                slot->pendingConvolution->prepare(spec);
+        }
+
+        slot->convolutionFadeRemaining = 0;
+        slot->kernelFadeRemaining = 0;
+
+        slot->slotBuffer.setSize(numChannels, currentBlockSize);
+        slot->fadeBuffer.setSize(numChannels, currentBlockSize);
+        slot->releaseInput.setSize(numChannels, currentBlockSize);
+        slot->releasing = false;
+        slot->attacking = false;
+        slot->releaseDrainSamples = 0;
+        slot->gainRamp.assign(static_cast<size_t>(currentBlockSize), 0.0f);
+
         // Setup parameter smoothing
         slot->gainSmoother.reset(currentSampleRate, kSmoothingTimeMs / 1000.0);
+        slot->activitySmoother.reset(currentSampleRate, kMuteRampMs / 1000.0);
     }
 
     // Setup master parameter smoothing
@@ -43,158 +117,360 @@ void ConvolutionEngine::prepare(const juce::dsp::ProcessSpec& spec)
     masterMixSmoother.reset(currentSampleRate, kSmoothingTimeMs / 1000.0);
 
     // Prepare processing buffers
-    dryBuffer.setSize(numChannels, currentBlockSize);
+    inputChannels.assign(static_cast<size_t>(numChannels), nullptr);
+    subBlockInputs.assign(static_cast<size_t>(numChannels), nullptr);
+    subBlockOutputs.assign(static_cast<size_t>(numChannels), nullptr);
+    wetGainRamp.assign(static_cast<size_t>(currentBlockSize), 0.0f);
+    dryGainRamp.assign(static_cast<size_t>(currentBlockSize), 0.0f);
     wetBuffer.setSize(numChannels, currentBlockSize);
-    slotBuffer.setSize(numChannels, currentBlockSize);
+    releaseOutput.setSize(numChannels, currentBlockSize);
+    silentInput.setSize(numChannels, currentBlockSize);
+    silentInput.clear();
+
+    {
+        const juce::ScopedLock poolLock(slotPoolLock);
+        slotPoolBlockSize = currentBlockSize;
+        slotPoolSampleRate = currentSampleRate;
+    }
+
+    updateSlotPool();
+
+    // prepare() sets the layout up itself, so a switch still on its way is dropped, and one
+    // still ringing out is cut short: the audio thread isn't running, so there is no tail to keep
+    std::unique_ptr<LayoutSwitch> supersededSwitch;
+    std::unique_ptr<LayoutSwitch> finishedSwitch;
+    {
+        const juce::SpinLock::ScopedLockType lock(kernelLock);
+        supersededSwitch = std::move(pendingLayoutSwitch);
+    }
+    {
+        const juce::SpinLock::ScopedLockType lock(drainLock);
+        if (outgoingLayout != nullptr)
+        {
+            clearLayoutKernels(outgoingLayout->layoutIndex);
+            sharedConvolvers[static_cast<size_t>(outgoingLayout->layoutIndex)].waitForBackgroundJobs();
+            finishedSwitch = std::move(outgoingLayout);
+        }
+    }
+
+    // Offline, nothing is gained by handing the tail to a worker: it only risks dropped blocks
+    const bool renderingOffline = nonRealtime.load();
+    auto& convolver = getSharedConvolver();
+    convolver.setUseBackgroundThread(!renderingOffline && juce::SystemStats::getNumCpus() > 1);
+    preparedNonRealtime.store(renderingOffline);
+
+    // Uniform partitions depend on the block size, so kernels are rebuilt if the layout moved
+    // (or if a dropped switch had loads build them for the other layout)
+    bool layoutChanged = false;
+    {
+        const juce::ScopedLock irLock(irDataLock); // keeps the composite builder off the convolver
+        layoutChanged = convolver.prepare(currentBlockSize, numChannels, maxIRLength,
+                                          static_cast<int>(irSlots.size()) * 2 + 1,
+                                          getLayoutForMode(processingMode.load(), renderingOffline));
+
+        layoutChanged = layoutChanged || kernelLayout != activeLayout.load();
+        kernelLayout = activeLayout.load();
+    }
+
+    if (layoutChanged)
+        rebuildSharedKernels();
+
+    // The release convolvers run the same kernels, so they follow the same layout, sized for every
+    // kernel the slot holds; one still waiting to be handed over with a kernel is replaced
+    {
+        const juce::ScopedLock irLock(irDataLock);
+
+        for (size_t i = 0; i < irSlots.size(); ++i)
+        {
+            auto& slot = *irSlots[i];
+            std::unique_ptr<PartitionedConvolver> unused;
+            int irLength = 1;
+            {
+                const juce::SpinLock::ScopedLockType lock(kernelLock);
+                unused = std::move(slot.pendingReleaseConvolver);
+                irLength = getHeldKernelLength(static_cast<int>(i));
+
+                for (const auto* kernel : { slot.fadingKernel.get(), slot.pendingKernel.get() })
+                    if (kernel != nullptr)
+                        irLength = juce::jmax(irLength, kernel->length);
+            }
+
+            slot.releaseConvolvers[getActiveLayout()]->prepare(currentBlockSize, numChannels, irLength, 2,
+                                                               getLayoutForMode(processingMode.load(), renderingOffline));
+        }
+    }
+
+    // A layout switch may have been waiting for the one cut short above to ring out
+    if (finishedSwitch != nullptr)
+        builderSignal.signal();
 }
 
 void ConvolutionEngine::process(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    auto& outputBlock = context.getOutputBlock();
+    const auto numSamples = static_cast<int>(outputBlock.getNumSamples());
+    const auto chunkSize = juce::jmax(1, currentBlockSize);
+
+    // Blocks larger than prepare() promised are split, so the buffers sized there always fit
+    // and nothing is resized here; smaller and variable blocks run as they come
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        auto chunk = outputBlock.getSubBlock(static_cast<size_t>(start),
+                                             static_cast<size_t>(juce::jmin(chunkSize, numSamples - start)));
+        juce::dsp::ProcessContextReplacing<float> chunkContext(chunk);
+        processChunk(chunkContext);
+    }
+}
+
+void ConvolutionEngine::processChunk(const juce::dsp::ProcessContextReplacing<float>& context)
 {
     auto& inputBlock = context.getInputBlock();
     auto& outputBlock = context.getOutputBlock();
     auto numSamples = static_cast<int>(inputBlock.getNumSamples());
 
-    // Store dry signal for mixing
-    dryBuffer.setSize(numChannels, numSamples, false, false, true);
+    // Nothing writes to the host block before the master stage, so the input is read in place
+    // as the dry signal rather than copied
     for (int ch = 0; ch < numChannels; ++ch)
+        inputChannels[static_cast<size_t>(ch)] = inputBlock.getChannelPointer(static_cast<size_t>(ch));
+
+    // Clear wet buffer
+    wetBuffer.clear(0, numSamples);
+
+    // Silent input that has outlasted an IR's tail can only convolve to zeros
+    if (isSilentInput(numSamples))
+        silentSamples = juce::jmin(silentSamples + numSamples, maxIRLength + kMaxRunCount);
+    else
+        silentSamples = 0;
+
+    if (overrunSlots != 0)
+        recoverOverrunSlots();
+
+    // Pick up mode changes and newly built kernels
+    const auto mode = processingMode.load();
+    if (mode != activeProcessingMode)
     {
-        dryBuffer.copyFrom(ch, 0, inputBlock.getChannelPointer(ch), numSamples);
+        activeProcessingMode = mode;
+
+        // Releases only exist in the shared modes, and neither path hears the other's history
+        for (auto& slotToReset : irSlots)
+        {
+            slotToReset->releasing = false;
+            slotToReset->attacking = false;
+            slotToReset->releaseDrainSamples = 0;
+        }
+
+        // The path that was idle has stale history, so start it from silence
+        if (mode != ProcessingMode::perSlot)
+            getSharedConvolver().reset();
+        else
+        {
+            // Overrun slots are reset once their task has finished
+            for (auto slotBits = ((1u << irSlots.size()) - 1u) & ~overrunSlots; slotBits != 0; slotBits &= slotBits - 1u)
+                irSlots[static_cast<size_t>(std::countr_zero(slotBits))]->convolution->reset();
+
+            processingDualMono.store(false);
+        }
     }
 
-    // Clear wet buffer
-    wetBuffer.setSize(numChannels, numSamples, false, false, true);
-    wetBuffer.clear();
+    if (kernelsPending.load())
+        adoptPendingKernels();
+
+    // Both shared modes run through the active shared convolver; a layout switch was picked up above
+    const bool useSharedSpectrum = (activeProcessingMode != ProcessingMode::perSlot);
+    std::fill(slotWeights.begin(), slotWeights.end(), 0.0f);
+    sharedSlots = 0;
+
+    // One consistent routing snapshot per block; only loaded slots are visited
+    blockRouting = routing.load();
+    const auto loadedSlots = getRoutingMask(blockRouting, loadedMask);
+    const auto unmutedSlots = loadedSlots & ~getRoutingMask(blockRouting, mutedMask);
+    const auto soloedSlots = loadedSlots & getRoutingMask(blockRouting, soloedMask);
+
+    // Solo overrides mute for its own slot; while any slot is soloed, only soloed slots play
+    const auto playingSlots = soloedSlots != 0 ? soloedSlots : unmutedSlots;
 
-    // Check if any slots are soloed and count them
-    bool hasAnySolo = hasAnySoloedSlots();
-    int numSoloEnabled = 0;
-    for (const auto& s : irSlots)
-        if (s->soloed.load() && s->hasIR.load())
-            ++numSoloEnabled;
     bool anySlotProcessed = false;
-    bool hasAnyLoadedIR = false;
+    bool anySlotPlaying = false;
+    bool anySlotConvolved = false;
+    const bool hasAnyLoadedIR = loadedSlots != 0;
+    juce::uint32 handledSlots = 0;
 
-    // Process each IR slot
-    for (size_t i = 0; i < irSlots.size(); ++i)
+    const auto allSlots = (1u << irSlots.size()) - 1u;
+    for (auto idleSlots = allSlots & ~loadedSlots & ~overrunSlots; idleSlots != 0; idleSlots &= idleSlots - 1u)
     {
-        auto& slot = *irSlots[i];
-        
-        // Skip if no IR loaded
-        if (!slot.hasIR.load())
-            continue;
-        hasAnyLoadedIR = true;
-
-        // Skip if muted (unless soloed) or if other slots are soloed (and this isn't)
-        const bool slotMuted = slot.muted.load();
-        const bool slotSoloed = slot.soloed.load();
-        const bool effectiveMuted = slotMuted && !slotSoloed; // Solo overrides mute for this slot
-        bool shouldPlay = !effectiveMuted && (!hasAnySolo || slotSoloed);
-        if (!shouldPlay)
-            continue;
+        auto& idleSlot = *irSlots[static_cast<size_t>(std::countr_zero(idleSlots))];
+        idleSlot.convolutionIdle = true;
+
+        if (idleSlot.releasing)
+            stopRelease(idleSlot);
+    }
+
+    // Process each loaded IR slot
+    for (auto slotBits = loadedSlots & ~overrunSlots; slotBits != 0; slotBits &= slotBits - 1u)
+    {
+        const auto i = std::countr_zero(slotBits);
+        const bool shouldPlay = ((playingSlots >> i) & 1u) != 0;
 
-        // Skip processing while this slot is loading a new IR to avoid transient crashes
-        if (slot.isLoading.load())
+        // A slot that stops playing ramps out and rings out its tail, then costs nothing
+        if (!updateSlotActivity(*irSlots[static_cast<size_t>(i)], shouldPlay, numSamples))
             continue;
 
-        // If this slot just loaded, allow exactly one block of dry-through to avoid perceived silence/glitch
-        if (slot.justLoaded.exchange(false))
+        handledSlots |= 1u << i;
+        if (runSlot(i, useSharedSpectrum, numSamples))
         {
-            for (int ch = 0; ch < numChannels; ++ch)
-                wetBuffer.addFrom(ch, 0, inputBlock.getChannelPointer(ch), numSamples, slot.gain.load());
             anySlotProcessed = true;
-            continue;
+            anySlotPlaying = anySlotPlaying || shouldPlay;
         }
-
-        // Process this slot
-        processSlot(static_cast<int>(i), context);
-        anySlotProcessed = true;
     }
 
     // If we had solos active but nothing played (e.g., transient state), fall back to non-solo logic
-    if (!anySlotProcessed && numSoloEnabled > 0)
+    // (no logging here: building the message would allocate on the audio thread)
+    if (!anySlotPlaying && soloedSlots != 0)
+    {
+        for (auto slotBits = unmutedSlots & ~handledSlots & ~overrunSlots; slotBits != 0; slotBits &= slotBits - 1u)
+        {
+            const auto i = std::countr_zero(slotBits);
+            updateSlotActivity(*irSlots[static_cast<size_t>(i)], true, numSamples);
+            if (runSlot(i, useSharedSpectrum, numSamples))
+                anySlotProcessed = true;
+        }
+    }
+
+    if (queuedSlots != 0)
+        anySlotConvolved = convolveQueuedSlots(context);
+
+    bool sharedConvolved = false;
+    if (useSharedSpectrum && anySlotProcessed)
     {
-        DBG("Convolution: No audio produced with solo active; falling back to non-solo mix for continuity");
+        bool weightsSettled = true;
         for (size_t i = 0; i < irSlots.size(); ++i)
+            if (slotWeights[i] != 0.0f && irSlots[i]->gainSmoother.isSmoothing())
+                weightsSettled = false;
+
+        updateComposite(weightsSettled, numSamples);
+
+        // Every installed kernel counts here, since a slot that just went quiet still rings
+        if (hasOutlastedTail(getSharedConvolver().getActiveKernelLength(nullptr), numSamples))
         {
-            auto& slot = *irSlots[i];
-            if (!slot.hasIR.load())
-                continue;
-            if (slot.isLoading.load())
-                continue;
-            if (slot.muted.load())
-                continue;
-            processSlot(static_cast<int>(i), context);
-            anySlotProcessed = true;
+            // The input history differs by less than the silence threshold, so it can be
+            // picked up as is when the input wakes the convolver again
+            dualMonoSamples = 0;
+            processingDualMono.store(false);
+            updateSharedSlotWeights(0, numSamples);
+        }
+        else
+        {
+            processSharedSpectrum(context);
+            anySlotConvolved = true;
+            sharedConvolved = true;
         }
     }
+    else
+    {
+        usingComposite.store(false);
+    }
+
+    drainOutgoingLayout(numSamples, sharedConvolved);
+
+    // The shared weights read how far each crossfade has got, so this comes after them
+    advanceCrossfades(numSamples);
+
+    sleeping.store(anySlotProcessed && !anySlotConvolved);
 
     // Apply master controls
     updateSmoothers();
-    
-    auto currentMasterGain = masterGainSmoother.getNextValue();
-    auto currentMasterMix = masterMixSmoother.getNextValue();
+    applyMasterSection(outputBlock, numSamples, anySlotProcessed, hasAnyLoadedIR);
+}
 
-    // Use whether any slot actually processed this block to decide mixing behavior
-    const bool hasActiveIRThisBlock = anySlotProcessed;
+void ConvolutionEngine::applyMasterSection(const juce::dsp::AudioBlock<float>& outputBlock, int numSamples,
+                                           bool hasActiveIR, bool hasAnyLoadedIR)
+{
+    // Cabinet mode: IRs completely replace the dry signal, and the mix blends between full dry (0)
+    // and full IR-processed (1). If IRs exist but none is active this block the output is silent;
+    // if none is loaded at all the input passes dry. Both choices are folded into two gain ramps,
+    // so every channel is one branch-free vector pass.
+    const auto wetAmount = hasActiveIR ? 1.0f : 0.0f;
+    const auto dryAmount = (hasActiveIR || !hasAnyLoadedIR) ? 1.0f : 0.0f;
 
-    for (int ch = 0; ch < numChannels; ++ch)
+    // Settled controls (nearly always) are a constant multiply per channel
+    if (!masterGainSmoother.isSmoothing() && !masterMixSmoother.isSmoothing())
     {
-        auto* outputData = outputBlock.getChannelPointer(ch);
-        auto* dryData = dryBuffer.getReadPointer(ch);
-        auto* wetData = wetBuffer.getReadPointer(ch);
+        const auto gain = masterGainSmoother.getTargetValue();
+        const auto wetGain = masterMixSmoother.getTargetValue() * gain * wetAmount;
+        const auto dryGain = (gain - wetGain) * dryAmount;
 
-        for (int sample = 0; sample < numSamples; ++sample)
+        for (int ch = 0; ch < numChannels; ++ch)
         {
-            float finalSample;
-            
-            if (hasActiveIRThisBlock)
-            {
-                // Cabinet mode: IRs completely replace the dry signal
-                // Mix control blends between full dry (0) and full IR-processed (1)
-                auto drySignal = dryData[sample] * (1.0f - currentMasterMix);
-                auto irSignal = wetData[sample] * currentMasterMix;
-                finalSample = (drySignal + irSignal) * currentMasterGain;
-            }
-            else
-            {
-                // If IRs exist but none active this block, output silence; if none loaded at all, pass dry
-                finalSample = hasAnyLoadedIR ? 0.0f : (dryData[sample] * currentMasterGain);
-            }
-            
-            outputData[sample] = finalSample;
-            
-            // Update smoothers for next sample
-            if (sample < numSamples - 1)
-            {
-                currentMasterGain = masterGainSmoother.getNextValue();
-                currentMasterMix = masterMixSmoother.getNextValue();
-            }
+            auto* outputData = outputBlock.getChannelPointer(static_cast<size_t>(ch));
+            juce::FloatVectorOperations::multiply(outputData, dryGain, numSamples);
+            juce::FloatVectorOperations::addWithMultiply(outputData, wetBuffer.getReadPointer(ch), wetGain, numSamples);
         }
+
+        return;
+    }
+
+    auto* wetGains = wetGainRamp.data();
+    auto* dryGains = dryGainRamp.data();
+
+    if (!fillRamp(masterGainSmoother, dryGains, numSamples, 1.0f))
+        juce::FloatVectorOperations::fill(dryGains, masterGainSmoother.getTargetValue(), numSamples);
+
+    if (!fillRamp(masterMixSmoother, wetGains, numSamples, wetAmount))
+        juce::FloatVectorOperations::fill(wetGains, masterMixSmoother.getTargetValue() * wetAmount, numSamples);
+
+    juce::FloatVectorOperations::multiply(wetGains, dryGains, numSamples);   // mix * gain
+    juce::FloatVectorOperations::subtract(dryGains, wetGains, numSamples);   // gain - wet
+    juce::FloatVectorOperations::multiply(dryGains, dryAmount, numSamples);
+
+    // The output block still holds the input
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* outputData = outputBlock.getChannelPointer(static_cast<size_t>(ch));
+        juce::FloatVectorOperations::multiply(outputData, dryGains, numSamples);
+        juce::FloatVectorOperations::addWithMultiply(outputData, wetBuffer.getReadPointer(ch), wetGains, numSamples);
     }
 }
 
 void ConvolutionEngine::reset()
 {
+    slotPool.waitForRunningTasks();
+    overrunSlots = 0;
+
     for (auto& slot : irSlots)
     {
         slot->convolution->reset();
         slot->gainSmoother.reset(currentSampleRate, kSmoothingTimeMs / 1000.0);
+        slot->activitySmoother.reset(currentSampleRate, kMuteRampMs / 1000.0);
+
+        // Nothing is left to fade out of
+        if (slot->fadingConvolution != nullptr)
+            slot->fadingConvolution->reset();
+
+        slot->convolutionFadeRemaining = 0;
+        slot->kernelFadeRemaining = 0;
+        slot->releasing = false;
+        slot->attacking = false;
+        slot->releaseDrainSamples = 0;
+    }
+
+    getSharedConvolver().reset();
+
+    // Nothing is left to ring out of a layout switch either; the next block retires it
+    {
+        const juce::SpinLock::ScopedLockType lock(drainLock);
+        if (outgoingLayout != nullptr)
+            outgoingLayout->drainSamples = 0;
     }
 
     masterGainSmoother.reset(currentSampleRate, kSmoothingTimeMs / 1000.0);
     masterMixSmoother.reset(currentSampleRate, kSmoothingTimeMs / 1000.0);
 
-    dryBuffer.clear();
     wetBuffer.clear();
-    slotBuffer.clear();
 }
 
 //==============================================================================
 bool ConvolutionEngine::loadImpulseResponse(int slotIndex, const juce::AudioBuffer<float>& irBuffer)
 {
-    DBG("=== CONVOLUTION ENGINE loadImpulseResponse START ===");
-    DBG("Loading IR for slot " << slotIndex << ", buffer channels: " << irBuffer.getNumChannels() << ", samples: " << irBuffer.getNumSamples());
-    
     if (slotIndex < 0 || slotIndex >= static_cast<int>(irSlots.size()))
     {
         DBG("ERROR: Invalid slot index " << slotIndex << " (slots available: " << irSlots.size() << ")");
@@ -202,59 +478,49 @@ bool ConvolutionEngine::loadImpulseResponse(int slotIndex, const juce::AudioBuff
     }
 
     auto& slot = *irSlots[slotIndex];
+    const juce::ScopedLock slotLoadLock(loadLock);
 
     try
     {
-        slot.isLoading.store(true);
-        DBG("Creating IR copy for JUCE convolution...");
-        // Load IR into convolution processor
-        // Create a copy that can be moved (JUCE 7 requires move semantics)
-        juce::AudioBuffer<float> irCopy = irBuffer;
-        
-        DBG("Calling JUCE convolution->loadImpulseResponse...");
-        slot.convolution->loadImpulseResponse(
-            std::move(irCopy),
-            currentSampleRate,
-            juce::dsp::Convolution::Stereo::yes,
-            juce::dsp::Convolution::Trim::yes,
-            juce::dsp::Convolution::Normalise::yes
-        );
-
-        DBG("JUCE convolution loadImpulseResponse completed successfully");
-        
-        // Force immediate convolution activation by resetting and preparing
-        DBG("Forcing convolution reset and prepare...");
-        slot.convolution->reset();
-        slot.convolution->prepare(juce::dsp::ProcessSpec{currentSampleRate,
-                                                         static_cast<juce::uint32>(currentBlockSize),
-                                                         static_cast<juce::uint32>(numChannels)});
-        
-        // Ensure immediate, non-faded activation for this slot
-        slot.gainSmoother.setCurrentAndTargetValue(slot.gain.load());
-        
-        // Prime the convolution to avoid first-block silence after load
-        {
-            const int warmupSamples = juce::jmax(currentBlockSize, 512);
-            juce::AudioBuffer<float> warmupBuffer(2, warmupSamples);
-            warmupBuffer.clear();
-            juce::dsp::AudioBlock<float> warmBlock(warmupBuffer);
-            juce::dsp::ProcessContextReplacing<float> warmCtx(warmBlock);
-            slot.convolution->process(warmCtx);
-        }
-        
-        DBG("Convolution forced to active state");
-        slot.hasIR.store(true);
-        slot.justLoaded.store(true);
-        slot.isLoading.store(false);
-        DBG("=== CONVOLUTION ENGINE loadImpulseResponse SUCCESS ===");
+        // Create a copy that can be moved (JUCE 7 requires move semantics); a stereo
+        // file with identical channels is reduced to mono so it only stores one channel
+        juce::AudioBuffer<float> irCopy = makeDistinctChannelIR(irBuffer);
+
+        // Same IR for the shared-spectrum kernel
+        auto conditioned = conditionImpulseResponse(irCopy);
+
+        // The live convolution is never touched here: a fresh one is prepared and handed to
+        // the audio thread, which crossfades to it
+        queueSlotConvolution(slotIndex, createSlotConvolution(irCopy));
+
+        // Shared-spectrum kernel from the same normalised IR the JUCE convolution uses
+        {
+            std::unique_ptr<PartitionedConvolver::Kernel> kernel;
+
+            // Built for the layout a pending switch is taking the convolver to, if there is one
+            const juce::ScopedLock irLock(irDataLock);
+            const auto& convolver = sharedConvolvers[static_cast<size_t>(kernelLayout)];
+            if (convolver.isPrepared())
+                kernel = convolver.createKernel(conditioned);
+
+            // Its release convolver has to fit it, and the kernel it crossfades from
+            std::unique_ptr<PartitionedConvolver> releaseConvolver;
+            if (kernel != nullptr)
+                releaseConvolver = createReleaseConvolver(slotIndex, kernel->length);
+
+            slot.sharedPath.store(getPathForKernel(kernel.get()));
+            slot.tailSamples.store(conditioned.getNumSamples());
+            slot.conditionedIR = std::move(conditioned);
+            queueSharedKernel(slotIndex, std::move(kernel), ++slot.irGeneration, std::move(releaseConvolver));
+        }
+
+        setRoutingBit(loadedMask, slotIndex, true);
         return true;
     }
     catch (const std::exception& e)
     {
         DBG("ERROR: Exception in convolution->loadImpulseResponse: " << e.what());
-        slot.hasIR.store(false);
-        slot.isLoading.store(false);
-        DBG("=== CONVOLUTION ENGINE loadImpulseResponse FAILED ===");
+        setRoutingBit(loadedMask, slotIndex, false);
         return false;
     }
 }
@@ -264,9 +530,64 @@ void ConvolutionEngine::clearImpulseResponse(int slotIndex)
     if (slotIndex < 0 || slotIndex >= static_cast<int>(irSlots.size()))
         return;
 
+    // The audio thread stops using the slot's convolution; the next load crossfades in from silence
+    const juce::ScopedLock slotLoadLock(loadLock);
     auto& slot = *irSlots[slotIndex];
-    slot.hasIR.store(false);
-    slot.convolution->reset();
+    setRoutingBit(loadedMask, slotIndex, false);
+
+    const juce::ScopedLock irLock(irDataLock);
+    slot.conditionedIR.setSize(0, 0);
+    slot.sharedPath.store(SlotPath::none);
+    slot.tailSamples.store(0);
+    queueSharedKernel(slotIndex, nullptr, ++slot.irGeneration);
+}
+
+std::unique_ptr<juce::dsp::Convolution> ConvolutionEngine::createSlotConvolution(const juce::AudioBuffer<float>& irBuffer) const
+{
+    auto convolution = std::make_unique<juce::dsp::Convolution>();
+    juce::AudioBuffer<float> irCopy = irBuffer;
+
+    convolution->loadImpulseResponse(
+        std::move(irCopy),
+        currentSampleRate,
+        irBuffer.getNumChannels() > 1 ? juce::dsp::Convolution::Stereo::yes : juce::dsp::Convolution::Stereo::no,
+        juce::dsp::Convolution::Trim::yes,
+        juce::dsp::Convolution::Normalise::yes
+    );
+
+    // Preparing runs the queued load, so the IR is active before the audio thread sees it
+    convolution->reset();
+    convolution->prepare(juce::dsp::ProcessSpec{currentSampleRate,
+                                                static_cast<juce::uint32>(currentBlockSize),
+                                                static_cast<juce::uint32>(numChannels)});
+
+    // Prime the convolution to avoid first-block silence after the swap
+    {
+        const int warmupSamples = juce::jmax(currentBlockSize, 512);
+        juce::AudioBuffer<float> warmupBuffer(juce::jmax(1, numChannels), warmupSamples);
+        warmupBuffer.clear();
+        juce::dsp::AudioBlock<float> warmBlock(warmupBuffer);
+        juce::dsp::ProcessContextReplacing<float> warmCtx(warmBlock);
+        convolution->process(warmCtx);
+    }
+
+    return convolution;
+}
+
+void ConvolutionEngine::queueSlotConvolution(int slotIndex, std::unique_ptr<juce::dsp::Convolution> convolution)
+{
+    auto& slot = *irSlots[static_cast<size_t>(slotIndex)];
+
+    // A pending convolution the audio thread never picked up is released outside the lock
+    std::unique_ptr<juce::dsp::Convolution> retired;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(kernelLock);
+        retired = std::move(slot.pendingConvolution);
+        slot.pendingConvolution = std::move(convolution);
+        slot.hasPendingConvolution = true;
+        kernelsPending.store(true);
+    }
 }
 
 bool ConvolutionEngine::isIRLoaded(int slotIndex) const
@@ -274,7 +595,33 @@ bool ConvolutionEngine::isIRLoaded(int slotIndex) const
     if (slotIndex < 0 || slotIndex >= static_cast<int>(irSlots.size()))
         return false;
 
-    return irSlots[slotIndex]->hasIR.load();
+    return isRoutingBitSet(loadedMask, slotIndex);
+}
+
+double ConvolutionEngine::getTailLengthSeconds() const
+{
+    int tailSamples = 0;
+
+    for (size_t i = 0; i < irSlots.size(); ++i)
+        if (isRoutingBitSet(loadedMask, static_cast<int>(i)))
+            tailSamples = juce::jmax(tailSamples, irSlots[i]->tailSamples.load());
+
+    return static_cast<double>(tailSamples) / currentSampleRate;
+}
+
+ConvolutionEngine::SlotPath ConvolutionEngine::getSlotPath(int slotIndex) const
+{
+    if (slotIndex < 0 || slotIndex >= static_cast<int>(irSlots.size()))
+        return SlotPath::none;
+
+    const auto& slot = *irSlots[static_cast<size_t>(slotIndex)];
+    if (! isRoutingBitSet(loadedMask, slotIndex))
+        return SlotPath::none;
+
+    if (processingMode.load() == ProcessingMode::perSlot)
+        return SlotPath::convolution;
+
+    return slot.sharedPath.load();
 }
 
 //==============================================================================
@@ -293,7 +640,7 @@ void ConvolutionEngine::setSlotMute(int slotIndex, bool muted)
     if (slotIndex < 0 || slotIndex >= static_cast<int>(irSlots.size()))
         return;
 
-    irSlots[slotIndex]->muted.store(muted);
+    setRoutingBit(mutedMask, slotIndex, muted);
 }
 
 void ConvolutionEngine::setSlotSolo(int slotIndex, bool soloed)
@@ -301,7 +648,7 @@ void ConvolutionEngine::setSlotSolo(int slotIndex, bool soloed)
     if (slotIndex < 0 || slotIndex >= static_cast<int>(irSlots.size()))
         return;
 
-    irSlots[slotIndex]->soloed.store(soloed);
+    setRoutingBit(soloedMask, slotIndex, soloed);
 }
 
 void ConvolutionEngine::setSlotPhaseInvert(int slotIndex, bool inverted)
@@ -309,10 +656,57 @@ void ConvolutionEngine::setSlotPhaseInvert(int slotIndex, bool inverted)
     if (slotIndex < 0 || slotIndex >= static_cast<int>(irSlots.size()))
         return;
 
-    irSlots[slotIndex]->phaseInverted.store(inverted);
+    setRoutingBit(invertedMask, slotIndex, inverted);
+}
+
+void ConvolutionEngine::setRoutingBit(RoutingMask mask, int slotIndex, bool shouldBeSet) noexcept
+{
+    const auto bit = juce::uint64{ 1 } << (static_cast<int>(mask) * kRoutingMaskBits + slotIndex);
+
+    // Hosts push every parameter on every block, so unchanged state doesn't write
+    if (((routing.load() & bit) != 0) == shouldBeSet)
+        return;
+
+    if (shouldBeSet)
+        routing.fetch_or(bit);
+    else
+        routing.fetch_and(~bit);
+}
+
+bool ConvolutionEngine::isRoutingBitSet(RoutingMask mask, int slotIndex) const noexcept
+{
+    return ((getRoutingMask(routing.load(), mask) >> slotIndex) & 1u) != 0;
+}
+
+
+
+void ConvolutionEngine::setProcessingMode(ProcessingMode mode)
+{
+    processingMode.store(mode);
+    updateSlotPool();
 }
 
+void ConvolutionEngine::setNonRealtime(bool shouldRenderOffline)
+{
+    // Hosts may call this from the audio thread on every block, so it only flags a change and
+    // leaves building the other layout to the composite builder thread
+    if (nonRealtime.exchange(shouldRenderOffline) == shouldRenderOffline)
+        return;
+
+    // Until the offline layout is in, the realtime one waits for its tail worker rather than
+    // dropping late blocks from the render
+    for (auto& convolver : sharedConvolvers)
+        convolver.setWaitForLateJobs(shouldRenderOffline);
 
+    layoutRequest.fetch_add(1);
+    builderSignal.signal();
+}
+
+void ConvolutionEngine::setParallelSlotThreshold(int minBlockSize)
+{
+    parallelSlotThreshold.store(juce::jmax(0, minBlockSize));
+    updateSlotPool();
+}
 
 void ConvolutionEngine::setMasterGain(float gain)
 {
@@ -336,66 +730,1462 @@ void ConvolutionEngine::updateSmoothers()
     if (!masterMixSmoother.isSmoothing())
         masterMixSmoother.setTargetValue(masterMix.load());
 
-    // Update slot smoothers
-    for (auto& slot : irSlots)
+    // Update slot smoothers (loaded slots only)
+    for (auto slotBits = getRoutingMask(blockRouting, loadedMask); slotBits != 0; slotBits &= slotBits - 1u)
     {
-        if (!slot->gainSmoother.isSmoothing())
-            slot->gainSmoother.setTargetValue(slot->gain.load());
+        auto& slot = *irSlots[static_cast<size_t>(std::countr_zero(slotBits))];
+        if (!slot.gainSmoother.isSmoothing())
+            slot.gainSmoother.setTargetValue(slot.gain.load());
     }
 }
 
-bool ConvolutionEngine::hasAnySoloedSlots() const
+bool ConvolutionEngine::updateSlotActivity(IRSlot& slot, bool shouldPlay, int numSamples)
 {
-    for (const auto& slot : irSlots)
+    // In the shared modes a slot going quiet keeps its kernel weight, and its release convolver takes
+    // the ramped-out input back out; it follows the ramp from wherever it is, so a mute mid-ramp is too
+    const bool useSharedSpectrum = activeProcessingMode != ProcessingMode::perSlot;
+    if (!shouldPlay && !slot.releasing && !slot.suspended && useSharedSpectrum)
+        startRelease(slot, false);
+
+    slot.activitySmoother.setTargetValue(shouldPlay ? 1.0f : 0.0f);
+
+    if (shouldPlay)
     {
-        if (slot->soloed.load() && slot->hasIR.load())
-            return true;
+        // A suspended convolution restarts from a clean state and ramps in from silence
+        // The shared convolver has heard the input all along, so there the kernel sits out and the
+        // release convolver plays the ramp in until that history has gone by
+        if (slot.suspended)
+        {
+            slot.suspended = false;
+            if (!useSharedSpectrum)
+                slot.convolution->reset();
+            else
+                startRelease(slot, true);
+        }
+
+        slot.mutedSamples = 0;
+
+        // Back at full level, a release convolver's input is zero, and an attack's matches what the
+        // kernel hears; either is done once the kernels have gone past the ramp
+        if (slot.releasing)
+        {
+            slot.releasedSamples = slot.activitySmoother.isSmoothing()
+                                     ? 0 : juce::jmin(slot.releasedSamples + numSamples, maxIRLength + kMaxRunCount);
+
+            if (slot.releasedSamples >= slot.releaseConvolvers[getActiveLayout()]->getActiveKernelLength(nullptr) + numSamples)
+            {
+                if (slot.attacking)
+                    stopRelease(slot);
+                else
+                    slot.releasing = false;
+            }
+        }
+
+        return true;
     }
+
+    if (slot.suspended)
+        return false;
+
+    // Still ramping out
+    if (slot.activitySmoother.isSmoothing())
+        return true;
+
+    // The slot's input is now zero; keep running it until its tail has rung out
+    slot.mutedSamples = juce::jmin(slot.mutedSamples + numSamples, maxIRLength + kMaxRunCount);
+    if (slot.mutedSamples < slot.tailSamples.load() + numSamples)
+        return true;
+
+    slot.suspended = true;
+
+    if (slot.releasing)
+        stopRelease(slot);
+
     return false;
 }
 
-void ConvolutionEngine::processSlot(int slotIndex, const juce::dsp::ProcessContextReplacing<float>& context)
+void ConvolutionEngine::startRelease(IRSlot& slot, bool attack)
 {
-    auto& slot = *irSlots[slotIndex];
-    auto& inputBlock = context.getInputBlock();
-    auto numSamples = static_cast<int>(inputBlock.getNumSamples());
+    // One still draining has heard its input all along, so it carries on the way it was going;
+    // both ways give the same output once the shared convolver's weight for the slot follows
+    if (slot.releaseDrainSamples <= 0)
+    {
+        // Otherwise it only ever hears the input from here on, so it starts from silence, with its
+        // partitions in step with the shared convolver's so the weights apply at the same points
+        auto& releaseConvolver = *slot.releaseConvolvers[getActiveLayout()];
+        releaseConvolver.resetInStepWith(getSharedConvolver());
+        releaseConvolver.setKernel(0, slot.sharedKernel.get());
+        releaseConvolver.setKernel(1, slot.fadingKernel.get());
+        slot.attacking = attack;
+    }
 
-    // Copy input to slot buffer
-    slotBuffer.setSize(numChannels, numSamples, false, false, true);
-    for (int ch = 0; ch < numChannels; ++ch)
+    slot.releasedSamples = 0;
+    slot.releaseDrainSamples = 0;
+    slot.releasing = true;
+}
+
+void ConvolutionEngine::stopRelease(IRSlot& slot)
+{
+    // Both convolvers still have output in flight from the weights they had, so the release
+    // convolver keeps running (and hearing its input) at zero weight until its share has come out too
+    slot.releasing = false;
+    slot.releaseWeights = {};
+    slot.releaseDrainSamples = slot.releaseConvolvers[getActiveLayout()]->getActiveKernelLength(nullptr) + currentBlockSize;
+}
+
+bool ConvolutionEngine::runSlot(int slotIndex, bool useSharedSpectrum, int numSamples)
+{
+    auto& slot = *irSlots[static_cast<size_t>(slotIndex)];
+
+    // Shared-spectrum slots only contribute a weight; the convolution runs once for all of them
+    if (useSharedSpectrum)
+    {
+        if (slot.sharedKernel == nullptr)
+            return false;
+
+        // The block's mean weight, for the composite and dual-mono checks; the smoothers are
+        // moved on by processSharedSpectrum() as it steps the weights through the block
+        auto gainRamp = slot.gainSmoother;
+        auto activityRamp = slot.activitySmoother;
+        const auto gain = advanceRamp(gainRamp, numSamples);
+
+        setSharedSlotWeight(slotIndex, isSlotInverted(slotIndex) ? -gain : gain,
+                            advanceRamp(activityRamp, numSamples), 0, numSamples);
+        sharedSlots |= 1u << slotIndex;
+        return true;
+    }
+
+    // Asleep: the convolution's history is silence, so skipping it is the same as feeding it zeros
+    if (slot.convolutionFadeRemaining == 0 && hasOutlastedTail(slot.convolution->getCurrentIRSize(), numSamples))
     {
-        slotBuffer.copyFrom(ch, 0, inputBlock.getChannelPointer(ch), numSamples);
+        slot.gainSmoother.skip(numSamples);
+        slot.activitySmoother.skip(numSamples);
+        return true;
     }
 
-    // Process through convolution
-    juce::dsp::AudioBlock<float> slotBlock(slotBuffer);
-    juce::dsp::ProcessContextReplacing<float> slotContext(slotBlock);
-    slot.convolution->process(slotContext);
+    // Per-slot convolutions are collected first, so they can be spread over the slot pool
+    queuedSlots |= 1u << slotIndex;
+    slot.convolutionIdle = false;
+    return true;
+}
 
-    // Apply slot controls
-    auto currentGain = slot.gainSmoother.getNextValue();
-    bool phaseInvert = slot.phaseInverted.load();
+void ConvolutionEngine::updateSlotPool()
+{
+    const juce::ScopedLock poolLock(slotPoolLock);
 
-    // Apply gain and phase
-    for (int sample = 0; sample < numSamples; ++sample)
+    // Slot workers only pay off when each slot has a large block of its own to convolve
+    const auto threshold = parallelSlotThreshold.load();
+    const auto numWorkers = juce::jmin(static_cast<int>(irSlots.size()), juce::SystemStats::getNumCpus()) - 1;
+    if (threshold > 0 && slotPoolBlockSize >= threshold && numWorkers > 0
+        && processingMode.load() == ProcessingMode::perSlot)
     {
-        auto processedSample0 = slotBuffer.getSample(0, sample) * currentGain;
-        if (phaseInvert) processedSample0 = -processedSample0;
-        
-        wetBuffer.addSample(0, sample, processedSample0);
+        slotPool.start(numWorkers, slotPoolBlockSize, slotPoolSampleRate);
+    }
+    else
+    {
+        slotPool.stop();
+    }
+}
 
-        if (numChannels >= 2)
+bool ConvolutionEngine::convolveQueuedSlots(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    const auto numSamples = static_cast<int>(context.getInputBlock().getNumSamples());
+    const bool parallel = std::popcount(queuedSlots) > 1 && slotPool.getNumWorkers() > 0
+                          && numSamples >= parallelSlotThreshold.load();
+    processingSlotsInParallel.store(parallel);
+
+    const juce::dsp::AudioBlock<const float> hostInput(context.getInputBlock().getSubsetChannelBlock(0, static_cast<size_t>(numChannels)));
+    auto convolvedSlots = queuedSlots;
+
+    if (parallel)
+    {
+        // The pool's tasks read a copy, so one that overruns the block never reads the host buffer
+        // after the callback has written its output there
+        for (auto slotBits = queuedSlots; slotBits != 0; slotBits &= slotBits - 1u)
         {
-            auto processedSample1 = slotBuffer.getSample(1, sample) * currentGain;
-            if (phaseInvert) processedSample1 = -processedSample1;
-            
-            wetBuffer.addSample(1, sample, processedSample1);
+            auto& slot = *irSlots[static_cast<size_t>(std::countr_zero(slotBits))];
+            stageSlotInput(slot, hostInput, numSamples, true);
+            slot.queuedSamples = numSamples;
         }
 
-        // Update smoothers for next sample
-        if (sample < numSamples - 1)
+        // A slot the pool didn't finish in time plays silence this block and sits out until its task
+        // is done (its convolution and scratch are still in use); the rest of the block carries on
+        const auto unfinished = slotPool.run(queuedSlots);
+        overrunSlots |= unfinished;
+        convolvedSlots &= ~unfinished;
+    }
+    else
+    {
+        // Only a mute/solo ramp needs a copy of the input; it is applied while making it
+        for (auto slotBits = queuedSlots; slotBits != 0; slotBits &= slotBits - 1u)
         {
-            currentGain = slot.gainSmoother.getNextValue();
+            const auto slotIndex = std::countr_zero(slotBits);
+            const bool staged = stageSlotInput(*irSlots[static_cast<size_t>(slotIndex)], hostInput, numSamples, false);
+            processSlot(slotIndex, hostInput, numSamples, staged);
         }
     }
+
+    // Summed in slot order either way, so parallel and serial output are identical
+    bool anyConvolved = false;
+    for (auto slotBits = convolvedSlots; slotBits != 0; slotBits &= slotBits - 1u)
+    {
+        const auto slotIndex = std::countr_zero(slotBits);
+        auto& slot = *irSlots[static_cast<size_t>(slotIndex)];
+
+        // Gain (ramp or constant) and phase flip fold into one multiply-add per channel
+        const auto sign = isSlotInverted(slotIndex) ? -1.0f : 1.0f;
+        auto* gains = slot.gainRamp.data();
+
+        if (fillRamp(slot.gainSmoother, gains, numSamples, sign))
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::addWithMultiply(wetBuffer.getWritePointer(ch), slot.slotBuffer.getReadPointer(ch),
+                                                             gains, numSamples);
+        }
+        else
+        {
+            const auto gain = slot.gainSmoother.getTargetValue() * sign;
+            for (int ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::addWithMultiply(wetBuffer.getWritePointer(ch), slot.slotBuffer.getReadPointer(ch),
+                                                             gain, numSamples);
+        }
+
+        anyConvolved = true;
+    }
+
+    queuedSlots = 0;
+    return anyConvolved;
+}
+
+void ConvolutionEngine::recoverOverrunSlots()
+{
+    const auto finished = overrunSlots & ~slotPool.getRunningTasks();
+
+    // The convolution missed the input of the blocks it sat out, so it starts again from silence
+    // and ramps back in, as after a mute
+    for (auto slotBits = finished; slotBits != 0; slotBits &= slotBits - 1u)
+    {
+        auto& slot = *irSlots[static_cast<size_t>(std::countr_zero(slotBits))];
+        slot.convolution->reset();
+
+        if (slot.fadingConvolution != nullptr)
+            slot.fadingConvolution->reset();
+
+        slot.activitySmoother.setCurrentAndTargetValue(0.0f);
+    }
+
+    overrunSlots &= ~finished;
+}
+
+bool ConvolutionEngine::stageSlotInput(IRSlot& slot, const juce::dsp::AudioBlock<const float>& hostInput,
+                                       int numSamples, bool alwaysCopy)
+{
+    auto& slotBuffer = slot.slotBuffer;
+
+    // Mute and solo ramp the slot's input rather than its output, so the tail rings out naturally
+    const bool ramped = slot.activitySmoother.isSmoothing() || slot.activitySmoother.getCurrentValue() < 1.0f;
+    if (ramped)
+    {
+        auto* activity = slot.gainRamp.data();
+
+        if (fillRamp(slot.activitySmoother, activity, numSamples, 1.0f))
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::multiply(slotBuffer.getWritePointer(ch), hostInput.getChannelPointer(static_cast<size_t>(ch)),
+                                                      activity, numSamples);
+        }
+        else
+        {
+            // Fully ramped out while the tail rings
+            for (int ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::multiply(slotBuffer.getWritePointer(ch), hostInput.getChannelPointer(static_cast<size_t>(ch)),
+                                                      slot.activitySmoother.getTargetValue(), numSamples);
+        }
+
+        return true;
+    }
+
+    if (!alwaysCopy)
+        return false;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::copy(slotBuffer.getWritePointer(ch), hostInput.getChannelPointer(static_cast<size_t>(ch)), numSamples);
+
+    return true;
+}
+
+void ConvolutionEngine::processSlot(int slotIndex, const juce::dsp::AudioBlock<const float>& hostInput,
+                                    int numSamples, bool inputStaged)
+{
+    auto& slot = *irSlots[static_cast<size_t>(slotIndex)];
+    auto& slotBuffer = slot.slotBuffer;
+    auto& fadeBuffer = slot.fadeBuffer;
+
+    // Convolved from the host block, or in place if the input was staged in the slot's scratch
+    auto slotBlock = juce::dsp::AudioBlock<float>(slotBuffer).getSubBlock(0, static_cast<size_t>(numSamples));
+    auto fadeBlock = juce::dsp::AudioBlock<float>(fadeBuffer).getSubBlock(0, static_cast<size_t>(numSamples));
+    const juce::dsp::AudioBlock<const float> stagedInput(slotBlock);
+
+    // The outgoing IR of a swap gets the same input
+    const bool fadeOutgoing = slot.convolutionFadeRemaining > 0
+                              && slot.fadeOutgoingConvolution && slot.fadingConvolution != nullptr;
+
+    if (fadeOutgoing)
+    {
+        juce::dsp::ProcessContextNonReplacing<float> fadeContext(inputStaged ? stagedInput : hostInput, fadeBlock);
+        slot.fadingConvolution->process(fadeContext);
+    }
+
+    // Process through convolution, into the slot's scratch
+    if (inputStaged)
+    {
+        juce::dsp::ProcessContextReplacing<float> slotContext(slotBlock);
+        slot.convolution->process(slotContext);
+    }
+    else
+    {
+        juce::dsp::ProcessContextNonReplacing<float> slotContext(hostInput, slotBlock);
+        slot.convolution->process(slotContext);
+    }
+
+    // Equal-power crossfade from the outgoing IR (or in from silence) after a swap
+    if (slot.convolutionFadeRemaining > 0)
+    {
+        const auto fadeStart = crossfadeSamples - slot.convolutionFadeRemaining;
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const auto progress = juce::jlimit(0.0f, 1.0f, static_cast<float>(fadeStart + sample)
+                                                           / static_cast<float>(juce::jmax(1, crossfadeSamples)));
+            const auto gainIn = std::sin(progress * juce::MathConstants<float>::halfPi);
+            const auto gainOut = std::cos(progress * juce::MathConstants<float>::halfPi);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto value = slotBuffer.getSample(ch, sample) * gainIn;
+                if (fadeOutgoing)
+                    value += fadeBuffer.getSample(ch, sample) * gainOut;
+
+                slotBuffer.setSample(ch, sample, value);
+            }
+        }
+    }
+
+    // Gain and phase are applied by the caller while summing the slots into the wet buffer
+}
+
+//==============================================================================
+void ConvolutionEngine::processSharedSpectrum(const juce::dsp::ProcessContextReplacing<float>& context)
+{
+    auto& inputBlock = context.getInputBlock();
+    const auto numSamples = static_cast<int>(inputBlock.getNumSamples());
+    const auto numChannelsToProcess = juce::jmin(numChannels, static_cast<int>(inputBlock.getNumChannels()));
+
+    // A mono source on a stereo bus through mono IRs gives the same wet signal on every
+    // channel once the channels have matched for longer than the IR, so only the first is
+    // convolved; the convolver keeps the others ready to rejoin on the next differing block
+    if (numChannelsToProcess > 1 && isDualMonoInput(numChannelsToProcess, numSamples))
+        dualMonoSamples = juce::jmin(dualMonoSamples + numSamples, maxIRLength + kMaxRunCount);
+    else
+        dualMonoSamples = 0;
+
+    // An attacking slot's kernel has no weight in the shared convolver, so it isn't checked there
+    bool anySlotAttacking = false;
+    for (const auto& slot : irSlots)
+        anySlotAttacking = anySlotAttacking || (slot->attacking && (slot->releasing || slot->releaseDrainSamples > 0));
+
+    const bool dualMono = dualMonoSamples > 0 && !anySlotAttacking
+                       && getSharedConvolver().areActiveKernelsMono(slotWeights.data())
+                       && dualMonoSamples >= getSharedConvolver().getActiveKernelLength(slotWeights.data()) + numSamples;
+    const auto numChannelsToConvolve = dualMono ? 1 : numChannelsToProcess;
+    processingDualMono.store(dualMono);
+
+    // Settled weights (nearly always) take one call for the whole block. Weights on the move are
+    // stepped through it, so gain and mute/solo ramps and IR crossfades don't step at the host
+    // block rate
+    const bool weightsMoving = !usingComposite.load() && areSharedSlotWeightsMoving();
+    const auto stepSize = weightsMoving ? kWeightUpdateSamples : numSamples;
+
+    // A releasing slot's convolver takes back the ramped-out part of the input, (1 - activity) * input;
+    // an attacking one plays the ramped-in part, activity * input. Draining ones keep hearing theirs
+    for (auto& slotToRelease : irSlots)
+    {
+        auto& slot = *slotToRelease;
+        if (!slot.releasing && slot.releaseDrainSamples <= 0)
+            continue;
+
+        auto activityRamp = slot.activitySmoother; // the weights move the smoother itself
+        auto* ramp = slot.gainRamp.data();
+
+        if (fillRamp(activityRamp, ramp, numSamples, slot.attacking ? 1.0f : -1.0f))
+        {
+            if (!slot.attacking)
+                juce::FloatVectorOperations::add(ramp, 1.0f, numSamples);
+
+            for (int ch = 0; ch < numChannelsToConvolve; ++ch)
+                juce::FloatVectorOperations::multiply(slot.releaseInput.getWritePointer(ch), inputChannels[static_cast<size_t>(ch)],
+                                                      ramp, numSamples);
+        }
+        else
+        {
+            const auto target = activityRamp.getTargetValue();
+            for (int ch = 0; ch < numChannelsToConvolve; ++ch)
+                juce::FloatVectorOperations::multiply(slot.releaseInput.getWritePointer(ch), inputChannels[static_cast<size_t>(ch)],
+                                                      slot.attacking ? target : 1.0f - target, numSamples);
+        }
+    }
+
+    for (int start = 0; start < numSamples; start += stepSize)
+    {
+        const auto numToProcess = juce::jmin(stepSize, numSamples - start);
+
+        if (weightsMoving)
+            updateSharedSlotWeights(start, numToProcess);
+
+        for (int ch = 0; ch < numChannelsToConvolve; ++ch)
+        {
+            subBlockInputs[static_cast<size_t>(ch)] = inputChannels[static_cast<size_t>(ch)] + start;
+            subBlockOutputs[static_cast<size_t>(ch)] = wetBuffer.getWritePointer(ch, start);
+        }
+
+        // The convolver reads the host block and replaces the wet buffer
+        getSharedConvolver().process(subBlockInputs.data(), subBlockOutputs.data(),
+                                     numChannelsToConvolve, numToProcess, slotWeights.data());
+
+        processReleases(numChannelsToConvolve, start, numToProcess);
+    }
+
+    if (!weightsMoving)
+        updateSharedSlotWeights(0, numSamples);
+
+    for (int ch = numChannelsToConvolve; ch < numChannelsToProcess; ++ch)
+        wetBuffer.copyFrom(ch, 0, wetBuffer, 0, 0, numSamples);
+}
+
+void ConvolutionEngine::processReleases(int numChannelsToProcess, int start, int numSamples)
+{
+    for (auto& slotToRelease : irSlots)
+    {
+        auto& slot = *slotToRelease;
+        if (!slot.releasing && slot.releaseDrainSamples <= 0)
+            continue;
+
+        for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        {
+            subBlockInputs[static_cast<size_t>(ch)] = slot.releaseInput.getReadPointer(ch, start);
+            subBlockOutputs[static_cast<size_t>(ch)] = releaseOutput.getWritePointer(ch);
+        }
+
+        // In a release its weights are the negated kernel weights, so adding it subtracts what the slot
+        // shouldn't hear; in an attack it is the slot
+        slot.releaseConvolvers[getActiveLayout()]->process(subBlockInputs.data(), subBlockOutputs.data(),
+                                                          numChannelsToProcess, numSamples, slot.releaseWeights.data());
+
+        for (int ch = 0; ch < numChannelsToProcess; ++ch)
+            wetBuffer.addFrom(ch, start, releaseOutput, ch, 0, numSamples);
+
+        if (!slot.releasing)
+            slot.releaseDrainSamples -= numSamples;
+    }
+}
+
+void ConvolutionEngine::drainOutgoingLayout(int numSamples, bool stillAudible)
+{
+    const juce::SpinLock::ScopedTryLockType lock(drainLock);
+    if (!lock.isLocked() || outgoingLayout == nullptr)
+        return;
+
+    auto& layoutSwitch = *outgoingLayout;
+    const auto layoutIndex = static_cast<size_t>(layoutSwitch.layoutIndex);
+
+    // Once the shared path has gone to sleep or stopped, there is no tail left to add to
+    if (!stillAudible)
+        layoutSwitch.drainSamples = 0;
+
+    if (layoutSwitch.drainSamples > 0)
+    {
+        // Convolution is linear: the outgoing layout rings out the input it heard before the switch,
+        // and the incoming one has heard everything since, so together they are one convolution
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            subBlockInputs[static_cast<size_t>(ch)] = silentInput.getReadPointer(ch);
+            subBlockOutputs[static_cast<size_t>(ch)] = releaseOutput.getWritePointer(ch);
+        }
+
+        sharedConvolvers[layoutIndex].process(subBlockInputs.data(), subBlockOutputs.data(),
+                                              numChannels, numSamples, layoutSwitch.weights.data());
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            wetBuffer.addFrom(ch, 0, releaseOutput, ch, 0, numSamples);
+
+        for (auto slotBits = layoutSwitch.releasingSlots; slotBits != 0; slotBits &= slotBits - 1u)
+        {
+            const auto i = std::countr_zero(slotBits);
+            irSlots[static_cast<size_t>(i)]->releaseConvolvers[layoutIndex]->process(
+                subBlockInputs.data(), subBlockOutputs.data(), numChannels, numSamples,
+                layoutSwitch.releaseWeights.data() + i * 2);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                wetBuffer.addFrom(ch, 0, releaseOutput, ch, 0, numSamples);
+        }
+
+        layoutSwitch.drainSamples -= numSamples;
+    }
+
+    if (layoutSwitch.drainSamples > 0 || !canRetire(1))
+        return;
+
+    // The reclaimer frees the outgoing kernels, so nothing may point at them any more
+    clearLayoutKernels(layoutSwitch.layoutIndex);
+    retire({ nullptr, nullptr, nullptr, std::move(outgoingLayout), nullptr });
+
+    // A switch back may be waiting for this layout to be free
+    builderSignal.signal();
+}
+
+void ConvolutionEngine::clearLayoutKernels(int layoutIndex)
+{
+    auto& convolver = sharedConvolvers[static_cast<size_t>(layoutIndex)];
+    for (int k = 0; k < static_cast<int>(slotWeights.size()); ++k)
+        convolver.setKernel(k, nullptr);
+
+    for (auto& slot : irSlots)
+    {
+        slot->releaseConvolvers[static_cast<size_t>(layoutIndex)]->setKernel(0, nullptr);
+        slot->releaseConvolvers[static_cast<size_t>(layoutIndex)]->setKernel(1, nullptr);
+    }
+}
+
+bool ConvolutionEngine::isSilentInput(int numSamples) const
+{
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(inputChannels[static_cast<size_t>(ch)], numSamples);
+        if (juce::jmax(-range.getStart(), range.getEnd()) > kSilenceThreshold)
+            return false;
+    }
+
+    return true;
+}
+
+bool ConvolutionEngine::isDualMonoInput(int numChannelsToCheck, int numSamples) const
+{
+    const auto* first = inputChannels[0];
+
+    for (int ch = 1; ch < numChannelsToCheck; ++ch)
+    {
+        const auto* other = inputChannels[static_cast<size_t>(ch)];
+
+        for (int i = 0; i < numSamples; ++i)
+            if (std::abs(first[i] - other[i]) > kDualMonoTolerance)
+                return false;
+    }
+
+    return true;
+}
+
+void ConvolutionEngine::adoptPendingKernels()
+{
+    const juce::SpinLock::ScopedTryLockType lock(kernelLock);
+    if (!lock.isLocked())
+        return; // Try again next block rather than waiting on the message thread
+
+    // Kernels and composites queued after a layout switch are built for its layout, so they wait for it
+    if (pendingLayoutSwitch != nullptr && !adoptLayoutSwitch())
+        return;
+
+    bool allAdopted = true;
+
+    for (size_t i = 0; i < irSlots.size(); ++i)
+    {
+        auto& slot = *irSlots[i];
+
+        // A pool task may still be using an overrun slot's convolution
+        if (slot.hasPendingConvolution && (((overrunSlots >> i) & 1u) != 0 || !adoptPendingConvolution(slot)))
+            allAdopted = false;
+
+        if (slot.hasPendingKernel && !adoptPendingKernel(static_cast<int>(i)))
+            allAdopted = false;
+    }
+
+    if (hasPendingComposite)
+    {
+        if (activeComposite == nullptr || canRetire(1))
+        {
+            auto outgoing = std::move(activeComposite);
+            activeComposite = std::move(pendingComposite);
+            hasPendingComposite = false;
+            getSharedConvolver().setKernel(static_cast<int>(irSlots.size()),
+                                           activeComposite != nullptr ? activeComposite->kernel.get() : nullptr);
+
+            if (outgoing != nullptr)
+                retire({ nullptr, nullptr, std::move(outgoing), nullptr, nullptr });
+        }
+        else
+        {
+            allAdopted = false;
+        }
+    }
+
+    // Swaps held back by a running crossfade are picked up on a later block
+    if (allAdopted)
+        kernelsPending.store(false);
+}
+
+bool ConvolutionEngine::adoptLayoutSwitch()
+{
+    // A running IR crossfade finishes in the layout it started in
+    for (const auto& slot : irSlots)
+        if (slot->kernelFadeRemaining > 0)
+            return false;
+
+    // The builder re-prepares the outgoing convolver under this lock, and only one layout rings out at a time
+    const juce::SpinLock::ScopedTryLockType lock(drainLock);
+    if (!lock.isLocked() || outgoingLayout != nullptr)
+        return false;
+
+    auto layoutSwitch = std::move(pendingLayoutSwitch);
+    const auto outgoingIndex = activeLayout.load();
+    const auto incomingIndex = static_cast<size_t>(layoutSwitch->layoutIndex);
+    auto& incoming = sharedConvolvers[incomingIndex];
+    incoming.reset();
+
+    // The outgoing convolver rings out with the weights of the last block it ran, and the switch
+    // keeps the kernels it ran them with alive until it is done
+    std::copy(slotWeights.begin(), slotWeights.end(), layoutSwitch->weights.begin());
+    layoutSwitch->releasingSlots = 0;
+
+    // The slot entries already hold the next block's weights; a composite stood in for them
+    if (usingComposite.load())
+        std::fill(layoutSwitch->weights.begin(), layoutSwitch->weights.begin() + static_cast<std::ptrdiff_t>(irSlots.size()), 0.0f);
+
+    for (size_t i = 0; i < irSlots.size(); ++i)
+    {
+        auto& slot = *irSlots[i];
+        const auto slotIndex = static_cast<int>(i);
+
+        std::swap(slot.sharedKernel, layoutSwitch->kernels[i]);
+        std::swap(slot.fadingKernel, layoutSwitch->fadingKernels[i]);
+        slot.kernelGeneration = layoutSwitch->generations[i];
+        incoming.setKernel(slotIndex, slot.sharedKernel.get());
+        incoming.setKernel(getFadingKernelIndex(slotIndex), nullptr);
+
+        // A slot that is ringing out carries on in the new layout, and its old release convolver
+        // rings out next to the old shared one
+        if (slot.releasing || slot.releaseDrainSamples > 0)
+        {
+            layoutSwitch->releasingSlots |= 1u << i;
+            layoutSwitch->releaseWeights[i * 2] = slot.releaseWeights[0];
+            layoutSwitch->releaseWeights[i * 2 + 1] = slot.releaseWeights[1];
+        }
+
+        slot.releaseDrainSamples = 0;
+
+        if (slot.releasing)
+        {
+            auto& releaseConvolver = *slot.releaseConvolvers[incomingIndex];
+            releaseConvolver.resetInStepWith(incoming);
+            releaseConvolver.setKernel(0, slot.sharedKernel.get());
+            releaseConvolver.setKernel(1, nullptr);
+        }
+    }
+
+    // The composite was built for the old partitions; the builder will be asked again
+    std::swap(activeComposite, layoutSwitch->composite);
+    incoming.setKernel(static_cast<int>(irSlots.size()), nullptr);
+    compositeRequested = false;
+    settledSamples = 0;
+
+    layoutSwitch->drainSamples = sharedConvolvers[static_cast<size_t>(outgoingIndex)].getActiveKernelLength(nullptr)
+                               + currentBlockSize;
+    preparedNonRealtime.store(layoutSwitch->nonRealtime);
+    activeLayout.store(static_cast<int>(incomingIndex));
+
+    layoutSwitch->layoutIndex = outgoingIndex;
+    outgoingLayout = std::move(layoutSwitch);
+    return true;
+}
+
+bool ConvolutionEngine::adoptPendingConvolution(IRSlot& slot)
+{
+    // Let the running crossfade finish; rapid browsing only ever swaps to the newest IR
+    if (slot.convolutionFadeRemaining > 0)
+        return false;
+
+    // The outgoing convolution of the previous swap is retired, so it needs room in the queue
+    if (slot.fadingConvolution != nullptr && !canRetire(1))
+        return false;
+
+    if (slot.fadingConvolution != nullptr)
+        retire({ std::move(slot.fadingConvolution), nullptr, nullptr, nullptr, nullptr });
+
+    // The active one becomes the outgoing one
+    slot.fadingConvolution = std::move(slot.convolution);
+    slot.convolution = std::move(slot.pendingConvolution);
+    slot.hasPendingConvolution = false;
+
+    // An outgoing convolution that hasn't run since its IR was cleared only holds stale history
+    slot.fadeOutgoingConvolution = !slot.convolutionIdle;
+    slot.convolutionFadeRemaining = crossfadeSamples;
+    return true;
+}
+
+bool ConvolutionEngine::adoptPendingKernel(int slotIndex)
+{
+    auto& slot = *irSlots[static_cast<size_t>(slotIndex)];
+
+    if (slot.kernelFadeRemaining > 0)
+        return false;
+
+    // A release convolver sized for the new kernel is only swapped in while nothing is ringing out of the old one
+    const bool releaseRunning = slot.releasing || slot.releaseDrainSamples > 0;
+    if (slot.pendingReleaseConvolver != nullptr && releaseRunning)
+        return false;
+
+    if ((slot.fadingKernel != nullptr || slot.pendingReleaseConvolver != nullptr) && !canRetire(1))
+        return false;
+
+    // Same rotation as the convolutions; the outgoing kernel of the last swap is only retired
+    // once the convolver has stopped pointing at it
+    auto retiredKernel = std::move(slot.fadingKernel);
+    slot.fadingKernel = std::move(slot.sharedKernel);
+    slot.sharedKernel = std::move(slot.pendingKernel);
+    slot.hasPendingKernel = false;
+    slot.kernelGeneration = slot.pendingGeneration;
+
+    getSharedConvolver().setKernel(slotIndex, slot.sharedKernel.get());
+    getSharedConvolver().setKernel(getFadingKernelIndex(slotIndex), slot.fadingKernel.get());
+    slot.kernelFadeRemaining = crossfadeSamples;
+
+    if (releaseRunning)
+    {
+        auto& releaseConvolver = *slot.releaseConvolvers[getActiveLayout()];
+        releaseConvolver.setKernel(0, slot.sharedKernel.get());
+        releaseConvolver.setKernel(1, slot.fadingKernel.get());
+    }
+
+    // The new release convolver was built for the same layout as the kernel; the old one goes
+    std::unique_ptr<PartitionedConvolver> retiredReleaseConvolver = std::move(slot.pendingReleaseConvolver);
+    if (retiredReleaseConvolver != nullptr && static_cast<size_t>(slot.pendingReleaseLayout) == getActiveLayout())
+        std::swap(slot.releaseConvolvers[getActiveLayout()], retiredReleaseConvolver);
+
+    if (retiredKernel != nullptr || retiredReleaseConvolver != nullptr)
+        retire({ nullptr, std::move(retiredKernel), nullptr, nullptr, std::move(retiredReleaseConvolver) });
+
+    return true;
+}
+
+void ConvolutionEngine::setSharedSlotWeight(int slotIndex, float gain, float activity, int offset, int numSamples)
+{
+    auto& slot = *irSlots[static_cast<size_t>(slotIndex)];
+
+    // A releasing or attacking slot's mute/solo ramp is applied to the input of its release convolver
+    // instead; in an attack that convolver is all the slot's output
+    const auto weight = slot.releasing ? (slot.attacking ? 0.0f : gain) : gain * activity;
+    const auto releaseGain = !slot.releasing ? 0.0f : (slot.attacking ? gain : -gain);
+
+    if (slot.kernelFadeRemaining <= 0)
+    {
+        slotWeights[static_cast<size_t>(slotIndex)] = weight;
+        slot.releaseWeights = { releaseGain, 0.0f };
+        return;
+    }
+
+    // Weights are constant over a call, so the equal-power curve is sampled at the middle of it
+    const auto progress = getCrossfadeProgress(slot.kernelFadeRemaining - offset, crossfadeSamples, numSamples);
+    const auto incoming = std::sin(progress * juce::MathConstants<float>::halfPi);
+    const auto outgoing = slot.fadingKernel != nullptr ? std::cos(progress * juce::MathConstants<float>::halfPi) : 0.0f;
+
+    slotWeights[static_cast<size_t>(slotIndex)] = weight * incoming;
+    slot.releaseWeights = { releaseGain * incoming, releaseGain * outgoing };
+
+    if (slot.fadingKernel != nullptr)
+        slotWeights[static_cast<size_t>(getFadingKernelIndex(slotIndex))] = weight * outgoing;
+}
+
+void ConvolutionEngine::updateSharedSlotWeights(int offset, int numSamples)
+{
+    for (auto slotBits = sharedSlots; slotBits != 0; slotBits &= slotBits - 1u)
+    {
+        const auto i = std::countr_zero(slotBits);
+        auto& slot = *irSlots[static_cast<size_t>(i)];
+
+        const auto gain = advanceRamp(slot.gainSmoother, numSamples);
+        setSharedSlotWeight(i, isSlotInverted(i) ? -gain : gain, advanceRamp(slot.activitySmoother, numSamples),
+                            offset, numSamples);
+    }
+}
+
+bool ConvolutionEngine::areSharedSlotWeightsMoving() const
+{
+    for (auto slotBits = sharedSlots; slotBits != 0; slotBits &= slotBits - 1u)
+    {
+        const auto& slot = *irSlots[static_cast<size_t>(std::countr_zero(slotBits))];
+
+        // An IR crossfade moves the weights of both the incoming and the outgoing kernel; a
+        // releasing slot's mute/solo ramp doesn't touch them
+        if (slot.gainSmoother.isSmoothing() || slot.kernelFadeRemaining > 0
+            || (slot.activitySmoother.isSmoothing() && !slot.releasing))
+            return true;
+    }
+
+    return false;
+}
+
+void ConvolutionEngine::advanceCrossfades(int numSamples)
+{
+    // An overrun slot's task may still be reading its fade; it carries on once the slot is back
+    for (auto slotBits = ((1u << irSlots.size()) - 1u) & ~overrunSlots; slotBits != 0; slotBits &= slotBits - 1u)
+    {
+        auto& slot = *irSlots[static_cast<size_t>(std::countr_zero(slotBits))];
+        slot.convolutionFadeRemaining = juce::jmax(0, slot.convolutionFadeRemaining - numSamples);
+        slot.kernelFadeRemaining = juce::jmax(0, slot.kernelFadeRemaining - numSamples);
+    }
+}
+
+void ConvolutionEngine::retire(RetiredObjects&& objects) noexcept
+{
+    int start1, size1, start2, size2;
+    retirementFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    // Callers check canRetire() first, so the queue entry is empty and nothing is freed here
+    jassert(size1 == 1);
+    if (size1 == 0)
+        return;
+
+    retiredObjects[static_cast<size_t>(start1)] = std::move(objects);
+    retirementFifo.finishedWrite(1);
+    reclaimSignal.signal();
+}
+
+void ConvolutionEngine::reclaimRetiredObjects()
+{
+    const auto numReady = retirementFifo.getNumReady();
+    if (numReady == 0)
+        return;
+
+    {
+        // A tail job queued before the swap may still be reading a retired kernel; the lock
+        // keeps prepare() from rebuilding the convolver's stages under the wait
+        const juce::ScopedLock irLock(irDataLock);
+        for (const auto& convolver : sharedConvolvers)
+            convolver.waitForBackgroundJobs();
+    }
+
+    int start1, size1, start2, size2;
+    retirementFifo.prepareToRead(numReady, start1, size1, start2, size2);
+
+    for (int i = 0; i < size1; ++i)
+        retiredObjects[static_cast<size_t>(start1 + i)] = {};
+
+    for (int i = 0; i < size2; ++i)
+        retiredObjects[static_cast<size_t>(start2 + i)] = {};
+
+    retirementFifo.finishedRead(size1 + size2);
+}
+
+bool ConvolutionEngine::fillRamp(juce::LinearSmoothedValue<float>& smoother, float* ramp, int numSamples, float scale) noexcept
+{
+    if (!smoother.isSmoothing())
+        return false;
+
+    // A linear ramp is start + step * n until it reaches the target, so it can be written in one
+    // vectorisable pass and the smoother advanced once, instead of stepping it per sample
+    const auto start = smoother.getCurrentValue();
+    const auto target = smoother.getTargetValue();
+    const auto step = smoother.skip(1) - start;
+    const auto remainingSteps = (step != 0.0f) ? juce::roundToInt((target - start) / step) : 1;
+    const auto rampLength = juce::jlimit(0, numSamples, remainingSteps - 1);
+
+    for (int i = 0; i < rampLength; ++i)
+        ramp[i] = (start + step * static_cast<float>(i + 1)) * scale;
+
+    juce::FloatVectorOperations::fill(ramp + rampLength, target * scale, numSamples - rampLength);
+    smoother.skip(numSamples - 1);
+    return true;
+}
+
+float ConvolutionEngine::advanceRamp(juce::LinearSmoothedValue<float>& smoother, int numSamples) noexcept
+{
+    // The ramps are linear, so their mean over the samples is the mid-point of where they
+    // start and end; a settled value comes back exactly
+    const auto start = smoother.getCurrentValue();
+    return 0.5f * (start + smoother.skip(numSamples));
+}
+
+float ConvolutionEngine::getCrossfadeProgress(int remaining, int length, int numSamples)
+{
+    const auto position = static_cast<float>(length - remaining) + 0.5f * static_cast<float>(numSamples);
+    return juce::jlimit(0.0f, 1.0f, position / static_cast<float>(juce::jmax(1, length)));
+}
+
+void ConvolutionEngine::queueSharedKernel(int slotIndex, std::unique_ptr<PartitionedConvolver::Kernel> kernel,
+                                          juce::uint32 generation, std::unique_ptr<PartitionedConvolver> releaseConvolver)
+{
+    auto& slot = *irSlots[static_cast<size_t>(slotIndex)];
+
+    // A kernel still waiting in pendingKernel was never installed, so nothing can be reading
+    // it; it is released when 'unused' goes out of scope, outside the lock. Without a new release
+    // convolver, the one already waiting (if any) still fits
+    std::unique_ptr<PartitionedConvolver::Kernel> unused;
+    std::unique_ptr<PartitionedConvolver> unusedReleaseConvolver;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(kernelLock);
+        unused = std::move(slot.pendingKernel);
+        slot.pendingKernel = std::move(kernel);
+        slot.pendingGeneration = generation;
+        slot.hasPendingKernel = true;
+
+        if (releaseConvolver != nullptr)
+        {
+            unusedReleaseConvolver = std::move(slot.pendingReleaseConvolver);
+            slot.pendingReleaseConvolver = std::move(releaseConvolver);
+            slot.pendingReleaseLayout = kernelLayout;
+        }
+
+        kernelsPending.store(true);
+    }
+}
+
+std::unique_ptr<PartitionedConvolver> ConvolutionEngine::createReleaseConvolver(int slotIndex, int irLength)
+{
+    // Called with irDataLock held, for a kernel built for kernelLayout
+    auto& slot = *irSlots[static_cast<size_t>(slotIndex)];
+    const auto layoutIndex = static_cast<size_t>(kernelLayout);
+    int currentLength = 0;
+    {
+        const juce::SpinLock::ScopedLockType lock(kernelLock);
+        irLength = juce::jmax(irLength, getHeldKernelLength(slotIndex));
+
+        // The one the slot will have once the audio thread has caught up
+        const auto& current = (slot.pendingReleaseConvolver != nullptr && slot.pendingReleaseLayout == kernelLayout)
+                                  ? slot.pendingReleaseConvolver : slot.releaseConvolvers[layoutIndex];
+        currentLength = current->getMaxIRLength();
+    }
+
+    if (irLength == currentLength)
+        return nullptr;
+
+    auto releaseConvolver = std::make_unique<PartitionedConvolver>();
+    releaseConvolver->prepare(currentBlockSize, numChannels, irLength, 2, sharedConvolvers[layoutIndex].getLayout());
+    return releaseConvolver;
+}
+
+int ConvolutionEngine::getHeldKernelLength(int slotIndex) const
+{
+    // Called with kernelLock held: the longest kernel the slot may still be running when it adopts
+    // the next one for kernelLayout, which a pending layout switch will have handed it first
+    const auto& slot = *irSlots[static_cast<size_t>(slotIndex)];
+    int length = 1;
+
+    if (slot.sharedKernel != nullptr)
+        length = juce::jmax(length, slot.sharedKernel->length);
+
+    if (pendingLayoutSwitch != nullptr && pendingLayoutSwitch->layoutIndex == kernelLayout)
+        if (const auto& switchKernel = pendingLayoutSwitch->kernels[static_cast<size_t>(slotIndex)])
+            length = juce::jmax(length, switchKernel->length);
+
+    return length;
+}
+
+void ConvolutionEngine::rebuildSharedKernels()
+{
+    // Only called from prepare(), while the audio thread is stopped
+    const juce::ScopedLock irLock(irDataLock);
+    const juce::SpinLock::ScopedLockType lock(kernelLock);
+
+    for (size_t i = 0; i < irSlots.size(); ++i)
+    {
+        auto& slot = *irSlots[i];
+        slot.pendingKernel.reset();
+        slot.hasPendingKernel = false;
+        slot.fadingKernel.reset();
+        slot.kernelFadeRemaining = 0;
+        getSharedConvolver().setKernel(getFadingKernelIndex(static_cast<int>(i)), nullptr);
+
+        if (slot.conditionedIR.getNumSamples() > 0)
+            slot.sharedKernel = getSharedConvolver().createKernel(slot.conditionedIR);
+        else
+            slot.sharedKernel.reset();
+
+        slot.sharedPath.store(getPathForKernel(slot.sharedKernel.get()));
+        slot.kernelGeneration = slot.irGeneration;
+        getSharedConvolver().setKernel(static_cast<int>(i), slot.sharedKernel.get());
+    }
+
+    // The composite was built for the old partition size; the builder will be asked again
+    activeComposite.reset();
+    pendingComposite.reset();
+    hasPendingComposite = false;
+    compositeRequested = false;
+    settledSamples = 0;
+
+    kernelsPending.store(false);
+}
+
+bool ConvolutionEngine::buildLayoutSwitch()
+{
+    // Holding the load lock keeps IR loads and prepare() out, so the switch has every slot's latest IR
+    const juce::ScopedLock slotLoadLock(loadLock);
+    const bool renderingOffline = nonRealtime.load();
+    const auto numSlots = irSlots.size();
+
+    // While a switch is pending the audio thread adopts nothing else, so the pending kernels below hold still
+    bool switchPending = false;
+    {
+        const juce::SpinLock::ScopedLockType lock(kernelLock);
+        if (pendingLayoutSwitch != nullptr)
+        {
+            if (pendingLayoutSwitch->nonRealtime == renderingOffline)
+                return true; // already on its way
+
+            switchPending = true;
+        }
+    }
+
+    const auto activeIndex = static_cast<size_t>(activeLayout.load());
+    const auto targetLayout = getLayoutForMode(processingMode.load(), renderingOffline);
+
+    // The active layout may already suit the new rendering mode: the host switched back before the
+    // last switch was picked up, or both use the same layout (sharedSpectrum)
+    if (preparedNonRealtime.load() == renderingOffline || sharedConvolvers[activeIndex].getLayout() == targetLayout)
+    {
+        if (switchPending)
+        {
+            // Loads since the dropped switch built their kernels and release convolvers for its layout;
+            // from here on only the active layout's kernels count
+            const juce::ScopedLock irLock(irDataLock);
+            kernelLayout = static_cast<int>(activeIndex);
+
+            std::vector<std::unique_ptr<PartitionedConvolver::Kernel>> rebuiltKernels(numSlots);
+            std::vector<std::unique_ptr<PartitionedConvolver>> rebuiltReleaseConvolvers(numSlots);
+            std::vector<bool> rebuild(numSlots, false);
+
+            for (size_t i = 0; i < numSlots; ++i)
+            {
+                auto& slot = *irSlots[i];
+                {
+                    const juce::SpinLock::ScopedLockType lock(kernelLock);
+                    rebuild[i] = slot.hasPendingKernel && slot.pendingKernel != nullptr;
+                }
+
+                if (rebuild[i])
+                {
+                    rebuiltKernels[i] = sharedConvolvers[activeIndex].createKernel(slot.conditionedIR);
+                    slot.sharedPath.store(getPathForKernel(rebuiltKernels[i].get()));
+
+                    if (rebuiltKernels[i] != nullptr)
+                        rebuiltReleaseConvolvers[i] = createReleaseConvolver(static_cast<int>(i), rebuiltKernels[i]->length);
+                }
+            }
+
+            std::unique_ptr<LayoutSwitch> droppedSwitch;
+            std::unique_ptr<CompositeIR> droppedComposite;
+            {
+                const juce::SpinLock::ScopedLockType lock(kernelLock);
+                droppedSwitch = std::move(pendingLayoutSwitch);
+                droppedComposite = std::move(pendingComposite);
+                hasPendingComposite = false;
+
+                for (size_t i = 0; i < numSlots; ++i)
+                {
+                    if (rebuild[i])
+                        std::swap(irSlots[i]->pendingKernel, rebuiltKernels[i]);
+
+                    std::swap(irSlots[i]->pendingReleaseConvolver, rebuiltReleaseConvolvers[i]);
+                    irSlots[i]->pendingReleaseLayout = kernelLayout;
+                }
+            }
+        }
+
+        preparedNonRealtime.store(renderingOffline);
+        return true;
+    }
+
+    {
+        // The target may still be ringing out of the last switch; its tail is part of the output
+        const juce::SpinLock::ScopedLockType lock(drainLock);
+        if (outgoingLayout != nullptr)
+            return false;
+    }
+
+    // Everything the audio thread will need is allocated here
+    const auto targetIndex = 1 - activeIndex;
+    auto& convolver = sharedConvolvers[targetIndex];
+    auto layoutSwitch = std::make_unique<LayoutSwitch>();
+    layoutSwitch->layoutIndex = static_cast<int>(targetIndex);
+    layoutSwitch->nonRealtime = renderingOffline;
+    layoutSwitch->kernels.resize(numSlots);
+    layoutSwitch->fadingKernels.resize(numSlots);
+    layoutSwitch->generations.resize(numSlots);
+    layoutSwitch->weights.assign(slotWeights.size(), 0.0f);
+    layoutSwitch->releaseWeights.assign(numSlots * 2, 0.0f);
+
+    std::vector<std::unique_ptr<PartitionedConvolver::Kernel>> droppedKernels(numSlots);
+    std::vector<std::unique_ptr<PartitionedConvolver>> droppedReleaseConvolvers(numSlots);
+    std::unique_ptr<CompositeIR> droppedComposite;
+
+    const juce::ScopedLock irLock(irDataLock); // keeps the reclaimer off the convolver while it's prepared
+
+    {
+        // With no switch pending the audio thread can't start another drain
+        const juce::SpinLock::ScopedLockType lock(drainLock);
+        jassert(outgoingLayout == nullptr);
+
+        // Offline, nothing is gained by handing the tail to a worker: it only risks dropped blocks
+        convolver.setUseBackgroundThread(!renderingOffline && juce::SystemStats::getNumCpus() > 1);
+        convolver.prepare(currentBlockSize, numChannels, maxIRLength, static_cast<int>(slotWeights.size()), targetLayout);
+    }
+
+    // The audio thread can't reach the target's release convolvers until the switch is picked up
+    for (size_t i = 0; i < numSlots; ++i)
+    {
+        auto& slot = *irSlots[i];
+
+        if (slot.conditionedIR.getNumSamples() > 0)
+            layoutSwitch->kernels[i] = convolver.createKernel(slot.conditionedIR);
+
+        layoutSwitch->generations[i] = slot.irGeneration;
+        slot.sharedPath.store(getPathForKernel(layoutSwitch->kernels[i].get()));
+
+        const auto irLength = layoutSwitch->kernels[i] != nullptr ? layoutSwitch->kernels[i]->length : 1;
+        slot.releaseConvolvers[targetIndex]->prepare(currentBlockSize, numChannels, irLength, 2, targetLayout);
+    }
+
+    // Loads and composites from here on are built for the new layout
+    kernelLayout = static_cast<int>(targetIndex);
+
+    {
+        // Kernels still pending were built for the old layout, and the switch carries their IRs
+        const juce::SpinLock::ScopedLockType lock(kernelLock);
+
+        for (size_t i = 0; i < numSlots; ++i)
+        {
+            droppedKernels[i] = std::move(irSlots[i]->pendingKernel);
+            droppedReleaseConvolvers[i] = std::move(irSlots[i]->pendingReleaseConvolver);
+            irSlots[i]->hasPendingKernel = false;
+        }
+
+        droppedComposite = std::move(pendingComposite);
+        hasPendingComposite = false;
+        pendingLayoutSwitch = std::move(layoutSwitch);
+        kernelsPending.store(true);
+    }
+
+    return true;
+}
+
+PartitionedConvolver::Layout ConvolutionEngine::getLayoutForMode(ProcessingMode mode, bool renderingOffline)
+{
+    // Both layouts add no latency and give the same output; the non-uniform one only pays off
+    // when small realtime buffers would otherwise need thousands of tiny partitions
+    if (renderingOffline)
+        return PartitionedConvolver::Layout::uniform;
+
+    return mode == ProcessingMode::sharedSpectrum ? PartitionedConvolver::Layout::uniform
+                                                  : PartitionedConvolver::Layout::nonUniform;
+}
+
+ConvolutionEngine::SlotPath ConvolutionEngine::getPathForKernel(const PartitionedConvolver::Kernel* kernel)
+{
+    if (kernel == nullptr)
+        return SlotPath::none;
+
+    return kernel->path == PartitionedConvolver::Path::directFIR ? SlotPath::directFIR
+                                                                 : SlotPath::partitionedFFT;
+}
+
+//==============================================================================
+void ConvolutionEngine::updateComposite(bool weightsSettled, int numSamples)
+{
+    const auto numSlots = irSlots.size();
+    const auto compositeIndex = numSlots;
+
+    int numWeighted = 0;
+    bool weightsChanged = false;
+    for (size_t i = 0; i < numSlots; ++i)
+    {
+        if (slotWeights[i] != 0.0f)
+            ++numWeighted;
+
+        if (slotWeights[i] != observedWeights[i])
+        {
+            observedWeights[i] = slotWeights[i];
+            weightsChanged = true;
+        }
+    }
+
+    // A single slot gains nothing from collapsing, and a moving gain means a drag is in progress
+    if (numWeighted < 2 || !weightsSettled || weightsChanged)
+    {
+        settledSamples = 0;
+        compositeRequested = false;
+    }
+    else
+    {
+        settledSamples += numSamples;
+    }
+
+    const bool compositeUsable = numWeighted >= 2 && weightsSettled
+                                 && activeComposite != nullptr
+                                 && activeComposite->kernel != nullptr
+                                 && compositeMatches(*activeComposite);
+
+    if (compositeUsable)
+    {
+        // The composite carries every slot's contribution, so the per-slot kernels sit this block out
+        std::fill(slotWeights.begin(), slotWeights.begin() + static_cast<std::ptrdiff_t>(numSlots), 0.0f);
+        slotWeights[compositeIndex] = 1.0f;
+    }
+    else
+    {
+        slotWeights[compositeIndex] = 0.0f;
+
+        if (!compositeRequested && settledSamples >= static_cast<int>(currentSampleRate * kCompositeSettleMs / 1000.0))
+        {
+            // Publish the weight set and wake the builder thread
+            for (size_t i = 0; i < numSlots; ++i)
+            {
+                requestedWeights[i].store(slotWeights[i]);
+                requestedGenerations[i].store(irSlots[i]->kernelGeneration);
+            }
+            compositeRequest.fetch_add(1);
+            compositeRequested = true;
+            builderSignal.signal();
+        }
+    }
+
+    usingComposite.store(compositeUsable);
+}
+
+bool ConvolutionEngine::compositeMatches(const CompositeIR& composite) const
+{
+    for (size_t i = 0; i < irSlots.size(); ++i)
+    {
+        if (composite.weights[i] != observedWeights[i])
+            return false;
+
+        if (observedWeights[i] != 0.0f && composite.generations[i] != irSlots[i]->kernelGeneration)
+            return false;
+    }
+    return true;
+}
+
+void ConvolutionEngine::buildComposite()
+{
+    const auto numSlots = irSlots.size();
+    auto composite = std::make_unique<CompositeIR>();
+    composite->weights.resize(numSlots);
+    composite->generations.resize(numSlots);
+
+    for (size_t i = 0; i < numSlots; ++i)
+    {
+        composite->weights[i] = requestedWeights[i].load();
+        composite->generations[i] = requestedGenerations[i].load();
+    }
+
+    const juce::ScopedLock irLock(irDataLock);
+    const auto& convolver = sharedConvolvers[static_cast<size_t>(kernelLayout)];
+
+    if (!convolver.isPrepared())
+        return;
+
+    int partitionedLength = 0;
+    int directLength = 0;
+    int compositeChannels = 0;
+    for (size_t i = 0; i < numSlots; ++i)
+    {
+        if (composite->weights[i] == 0.0f)
+            continue;
+
+        const auto& slot = *irSlots[i];
+
+        // The IR was replaced since the request; the audio thread will ask again once it has the new kernel
+        if (slot.irGeneration != composite->generations[i] || slot.conditionedIR.getNumSamples() == 0)
+            return;
+
+        auto& length = (slot.sharedPath.load() == SlotPath::directFIR) ? directLength : partitionedLength;
+        length = juce::jmax(length, slot.conditionedIR.getNumSamples());
+        compositeChannels = juce::jmax(compositeChannels, slot.conditionedIR.getNumChannels());
+    }
+
+    if (partitionedLength == 0 && directLength == 0)
+        return;
+
+    // Gain, phase, mute and solo are linear, so the weighted IR sum convolves to the same output.
+    // Direct-FIR slots are summed apart from the partitioned ones so each part keeps its path
+    // and the audio thread can swap to the composite without a discontinuity
+    juce::AudioBuffer<float> partitionedIR(compositeChannels, partitionedLength);
+    juce::AudioBuffer<float> directIR(compositeChannels, directLength);
+    partitionedIR.clear();
+    directIR.clear();
+
+    for (size_t i = 0; i < numSlots; ++i)
+    {
+        const auto weight = composite->weights[i];
+        if (weight == 0.0f)
+            continue;
+
+        const auto& slot = *irSlots[i];
+        const auto& ir = slot.conditionedIR;
+        auto& target = (slot.sharedPath.load() == SlotPath::directFIR) ? directIR : partitionedIR;
+
+        for (int ch = 0; ch < compositeChannels; ++ch)
+            target.addFrom(ch, 0, ir, juce::jmin(ch, ir.getNumChannels() - 1), 0, ir.getNumSamples(), weight);
+    }
+
+    composite->kernel = convolver.createCombinedKernel(partitionedIR, directIR);
+    if (composite->kernel == nullptr)
+        return;
+
+    // As with kernels, a composite still pending was never installed
+    std::unique_ptr<CompositeIR> unused;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(kernelLock);
+        unused = std::move(pendingComposite);
+        pendingComposite = std::move(composite);
+        hasPendingComposite = true;
+        kernelsPending.store(true);
+    }
+}
+
+//==============================================================================
+ConvolutionEngine::CompositeBuilder::CompositeBuilder(ConvolutionEngine& ownerEngine)
+    : juce::Thread("KingsCab Composite IR"), owner(ownerEngine)
+{
+}
+
+ConvolutionEngine::CompositeBuilder::~CompositeBuilder()
+{
+    stopThread(2000);
+}
+
+void ConvolutionEngine::CompositeBuilder::run()
+{
+    // Sleeps until the audio thread signals a request, so an idle engine costs no wake-ups
+    bool layoutSwitchWaiting = false;
+
+    while (!threadShouldExit())
+    {
+        // A layout switch that had to wait for the last one to ring out is retried on a timer too
+        owner.builderSignal.wait(layoutSwitchWaiting ? kLayoutRetryMs : -1);
+
+        if (threadShouldExit())
+            break;
+
+        const auto layoutRequest = owner.layoutRequest.load();
+        layoutSwitchWaiting = layoutRequest != lastServedLayoutRequest && !owner.buildLayoutSwitch();
+
+        if (layoutRequest != lastServedLayoutRequest && !layoutSwitchWaiting)
+            lastServedLayoutRequest = layoutRequest;
+
+        const auto request = owner.compositeRequest.load();
+        if (request == lastServedRequest)
+            continue;
+
+        lastServedRequest = request;
+        owner.buildComposite();
+    }
+}
+
+juce::AudioBuffer<float> ConvolutionEngine::makeDistinctChannelIR(const juce::AudioBuffer<float>& irBuffer)
+{
+    const auto numIRSamples = irBuffer.getNumSamples();
+
+    if (irBuffer.getNumChannels() == 2 && numIRSamples > 0)
+    {
+        const auto* left = irBuffer.getReadPointer(0);
+        const auto* right = irBuffer.getReadPointer(1);
+
+        bool identical = true;
+        for (int i = 0; i < numIRSamples && identical; ++i)
+            identical = std::abs(left[i] - right[i]) <= kIdenticalChannelTolerance;
+
+        if (identical)
+        {
+            juce::AudioBuffer<float> mono(1, numIRSamples);
+            mono.copyFrom(0, 0, irBuffer, 0, 0, numIRSamples);
+            return mono;
+        }
+    }
+
+    return irBuffer;
+}
+
+juce::AudioBuffer<float> ConvolutionEngine::conditionImpulseResponse(const juce::AudioBuffer<float>& irBuffer)
+{
+    // Mirrors juce::dsp::Convolution's Trim::yes / Normalise::yes so both paths sound identical
+    const auto numIRChannels = irBuffer.getNumChannels();
+    const auto numIRSamples = irBuffer.getNumSamples();
+    const auto thresholdTrim = juce::Decibels::decibelsToGain(-80.0f);
+
+    int offsetBegin = numIRSamples;
+    int offsetEnd = numIRSamples;
+
+    for (int ch = 0; ch < numIRChannels; ++ch)
+    {
+        const auto* data = irBuffer.getReadPointer(ch);
+
+        int first = 0;
+        while (first < numIRSamples && std::abs(data[first]) < thresholdTrim)
+            ++first;
+
+        int last = 0;
+        while (last < numIRSamples && std::abs(data[numIRSamples - 1 - last]) < thresholdTrim)
+            ++last;
+
+        offsetBegin = juce::jmin(offsetBegin, first);
+        offsetEnd = juce::jmin(offsetEnd, last);
+    }
+
+    if (offsetBegin == numIRSamples)
+    {
+        juce::AudioBuffer<float> silent(juce::jmax(1, numIRChannels), 1);
+        silent.clear();
+        return silent;
+    }
+
+    const auto newLength = juce::jmax(1, numIRSamples - (offsetBegin + offsetEnd));
+    juce::AudioBuffer<float> result(numIRChannels, newLength);
+
+    float maxSumSquared = 0.0f;
+    for (int ch = 0; ch < numIRChannels; ++ch)
+    {
+        result.copyFrom(ch, 0, irBuffer, ch, offsetBegin, newLength);
+
+        const auto* data = result.getReadPointer(ch);
+        float sumSquared = 0.0f;
+        for (int i = 0; i < newLength; ++i)
+            sumSquared += data[i] * data[i];
+
+        maxSumSquared = juce::jmax(maxSumSquared, sumSquared);
+    }
+
+    const auto normalisationFactor = maxSumSquared < 1e-8f ? 1.0f : 0.125f / std::sqrt(maxSumSquared);
+    result.applyGain(normalisationFactor);
+
+    return result;
+}
+
+//==============================================================================
+ConvolutionEngine::Reclaimer::Reclaimer(ConvolutionEngine& ownerEngine)
+    : juce::Thread("KingsCab IR Reclaimer"), owner(ownerEngine)
+{
+}
+
+ConvolutionEngine::Reclaimer::~Reclaimer()
+{
+    stopThread(2000);
+}
+
+void ConvolutionEngine::Reclaimer::run()
+{
+    // Woken by retire(), so retiring costs the audio thread one FIFO write and one signal
+    while (!threadShouldExit())
+    {
+        owner.reclaimSignal.wait();
+        owner.reclaimRetiredObjects();
+    }
 }
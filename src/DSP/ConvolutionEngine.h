@@ -3,6 +3,10 @@
 #include <JuceHeader.h>
 #include <array>
 #include <atomic>
+#include <bit>
+#include "PartitionedConvolver.h"
+#include "RealtimeSignal.h"
+#include "SlotThreadPool.h"
 
 //==============================================================================
 /**
@@ -13,17 +17,71 @@
  * - Multiple IR slot management with individual controls
  * - Optimized for low CPU usage and minimal latency
  * - Thread-safe IR loading and unloading
+ * - Shared input-spectrum mode: one forward FFT per block for all slots
+ * - Zero-latency mode: direct-form head plus growing FFT partitions, preallocated
+ *   for maxIRLength at construction
+ * - Composite collapse: settled slots are pre-mixed into one IR in the background
+ * - Per-slot path choice: short IRs run as a direct-form FIR, longer ones as FFT partitions
+ * - Mono IRs stay mono (stereo files with identical channels are reduced to mono), so
+ *   every output channel reads one shared set of IR data
+ * - Dual-mono input (identical channels) through mono IRs is convolved once and copied
+ * - Click-free IR swaps: the new IR is fully prepared off the audio thread, then
+ *   equal-power crossfaded against the outgoing one
+ * - Nothing is freed on the audio thread: swapped-out convolutions, kernels and composites
+ *   go through a lock-free retirement queue and are reclaimed by a background thread
+ * - Silence sleep: once silent input has outlasted an IR's tail its convolution is skipped,
+ *   and the next non-silent block wakes it with no catch-up work
+ * - Muted and non-soloed slots ramp out, ring out their tail, then suspend at zero cost; in
+ *   the shared modes the kernel keeps its weight and a release convolver takes back the
+ *   input that arrived after the mute, so the tail is the same as in perSlot mode. On the
+ *   way back in the release convolver plays the ramp itself until the kernel's history is
+ *   all new, so nothing heard while suspended comes back. Release convolvers are sized to
+ *   the slot's IRs, not to maxIRLength
+ * - Host blocks of any size: larger ones are split into prepared-size chunks, so process()
+ *   never resizes or allocates
+ * - Offline rendering: both shared modes run uniform partitions sized to the host block,
+ *   with no direct-form head and no tail worker, for the same output at higher throughput.
+ *   The other layout is built in the background and swapped in at a block boundary, while
+ *   the outgoing one rings out what it has already heard
+ * - Per-slot mode at large block sizes: slot convolutions run in parallel on a small
+ *   work-stealing pool the audio thread joins, and are summed in slot order as before.
+ *   Each task convolves its own copy of the block, so one that overruns the block can be
+ *   left to finish: its slot plays silence meanwhile, then ramps back in from a reset
+ * - No input copies otherwise: slots convolve straight from the host block into their own
+ *   scratch, and gain, phase, mix and master gain are applied as vector multiply-adds
+ * - Block-rate smoothing: settled gains are one constant multiply per block, and ramps are
+ *   written in a single pass shared by every channel; in the shared modes, where gains are
+ *   kernel weights, a moving weight (including an IR crossfade) is stepped every
+ *   kWeightUpdateSamples instead
+ * - Lock-free routing snapshot: loaded/mute/solo/phase state lives in one atomic word of
+ *   per-slot bitmasks, read once per block, and only loaded slots are visited
  */
 class ConvolutionEngine
 {
 public:
     //==============================================================================
-    ConvolutionEngine(int numSlots, int maxIRLength);
+    enum class ProcessingMode
+    {
+        perSlot,        // One juce::dsp::Convolution per slot
+        sharedSpectrum, // All slots accumulate against one input spectrum, uniform partitions
+        zeroLatency     // As sharedSpectrum, with a non-uniform layout for small host buffers
+    };
+
+    enum class SlotPath
+    {
+        none,           // No IR loaded
+        convolution,    // juce::dsp::Convolution (perSlot mode)
+        directFIR,      // Direct-form FIR in the shared convolver
+        partitionedFFT  // FFT partitions in the shared convolver
+    };
+
+    //==============================================================================
+    ConvolutionEngine(int numSlots, int maxIRLengthToUse);
     ~ConvolutionEngine();
 
     //==============================================================================
     void prepare(const juce::dsp::ProcessSpec& spec);
-    void process(const juce::dsp::ProcessContextReplacing<float>& context);
+    void process(const juce::dsp::ProcessContextReplacing<float>& context);  // any block size, never allocates
     void reset();
 
     //==============================================================================
@@ -32,6 +90,9 @@ public:
     void clearImpulseResponse(int slotIndex);
     bool isIRLoaded(int slotIndex) const;
 
+    // Longest loaded IR at the current sample rate: how long output continues after the input stops
+    double getTailLengthSeconds() const;
+
     //==============================================================================
     // Real-time parameter control (thread-safe)
     void setSlotGain(int slotIndex, float gain);
@@ -43,21 +104,106 @@ public:
     void setMasterGain(float gain);
     void setMasterMix(float mix);
 
+    //==============================================================================
+    // Processing mode (message thread; takes effect on the next processed block. Switching between
+    // the two shared layouts reallocates, so that part waits for the next prepare())
+    void setProcessingMode(ProcessingMode mode);
+    ProcessingMode getProcessingMode() const { return processingMode.load(); }
+
+    // Offline rendering (bounce, freeze): latency no longer matters, so the shared modes switch
+    // to the throughput layout. Safe from any thread, including the audio thread: the layout is
+    // built in the background and picked up by a later block (or set up by prepare()).
+    void setNonRealtime(bool shouldRenderOffline);
+    bool isPreparedForNonRealtime() const { return preparedNonRealtime.load(); }
+
+    // Smallest block at which per-slot mode spreads slot convolutions over worker threads
+    // (0 turns it off). Workers are started or stopped straight away (call from the message
+    // thread) and only run when the prepared block size and mode can use them; below the
+    // threshold slots run serially on the audio thread.
+    void setParallelSlotThreshold(int minBlockSize);
+    bool isProcessingSlotsInParallel() const { return processingSlotsInParallel.load(); }
+
+    // True while the audio thread is running the pre-mixed composite IR instead of per-slot kernels
+    bool isUsingCompositeIR() const { return usingComposite.load(); }
+
+    // Which convolution path a slot's IR runs on in the current processing mode
+    SlotPath getSlotPath(int slotIndex) const;
+
+    // True while identical input channels are being convolved once and copied (shared modes only)
+    bool isProcessingDualMono() const { return processingDualMono.load(); }
+
+    // True while silent input has outlasted every IR tail and no convolution is running
+    bool isSleeping() const { return sleeping.load(); }
+
+    // Late-tail blocks the background worker didn't deliver in time (played as silence)
+    int getNumMissedTailDeadlines() const
+    {
+        return sharedConvolvers[0].getNumMissedDeadlines() + sharedConvolvers[1].getNumMissedDeadlines();
+    }
+
 private:
     //==============================================================================
     struct IRSlot
     {
+        std::atomic<float> gain{ 1.0f };   // loaded/mute/solo/phase live in the routing word
+        std::atomic<SlotPath> sharedPath{ SlotPath::none };  // path of the latest shared kernel
+        std::atomic<int> tailSamples{ 0 };                   // length of the latest IR
+
+        // Per-slot convolutions: the active and outgoing ones belong to the audio thread, the
+        // pending one is handed over under kernelLock
         std::unique_ptr<juce::dsp::Convolution> convolution;
-        std::atomic<float> gain{ 1.0f };
-        std::atomic<bool> muted{ false };
-        std::atomic<bool> soloed{ false };
-        std::atomic<bool> phaseInverted{ false };
-        std::atomic<bool> hasIR{ false };
-        std::atomic<bool> isLoading{ false };
-        std::atomic<bool> justLoaded{ false };
+        std::unique_ptr<juce::dsp::Convolution> fadingConvolution;
+        std::unique_ptr<juce::dsp::Convolution> pendingConvolution;
+        bool hasPendingConvolution = false;
+        bool fadeOutgoingConvolution = false;    // audio thread: the outgoing one was in use
+        bool convolutionIdle = true;             // audio thread: no IR since the last swap
+        int convolutionFadeRemaining = 0;        // audio thread
+
+        // Per-slot scratch, so slots can be convolved on different threads (audio thread / pool)
+        juce::AudioBuffer<float> slotBuffer;
+        juce::AudioBuffer<float> fadeBuffer;
+        std::vector<float> gainRamp;    // activity ramp while convolving, then signed gain ramp while mixing
+        int queuedSamples = 0;          // block length for a pool task, which reads the input from slotBuffer
+
+        // Shared-spectrum kernels: the active one belongs to the audio thread, the
+        // pending one is handed over under kernelLock
+        std::unique_ptr<PartitionedConvolver::Kernel> sharedKernel;
+        std::unique_ptr<PartitionedConvolver::Kernel> fadingKernel;     // audio thread, crossfaded out
+        std::unique_ptr<PartitionedConvolver::Kernel> pendingKernel;
+        int kernelFadeRemaining = 0;         // audio thread
+        bool hasPendingKernel = false;
+        juce::uint32 kernelGeneration = 0;   // audio thread
+        juce::uint32 pendingGeneration = 0;  // guarded by kernelLock
+
+        // Normalised IR kept so kernels can be rebuilt when the block size changes
+        juce::AudioBuffer<float> conditionedIR;
+        juce::uint32 irGeneration = 0;       // guarded by irDataLock
         
         // Smoothed parameters for click-free operation
         juce::LinearSmoothedValue<float> gainSmoother;
+
+        // Mute/solo: the input ramps out, the tail rings out, then the slot is suspended (audio thread)
+        juce::LinearSmoothedValue<float> activitySmoother{ 1.0f };
+        int mutedSamples = 0;    // how long the ramped-out input has been zero
+        bool suspended = false;
+
+        // Shared modes: every slot reads the same input, so a muted slot's kernel keeps its weight
+        // and this convolver subtracts what the ramped-out part of the input adds to it. Coming back
+        // from suspension it runs the other way (an attack): the kernel sits out and this convolver
+        // plays the ramped-in input itself, until the shared convolver's history of the slot is all
+        // new (audio thread)
+        std::array<std::unique_ptr<PartitionedConvolver>, 2> releaseConvolvers;   // one per shared layout, like the shared convolvers
+        juce::AudioBuffer<float> releaseInput;   // (1 - activity) * input, or activity * input in an attack
+        std::array<float, 2> releaseWeights{};   // the slot's kernel and its outgoing one
+        bool releasing = false;                  // running at its weights, in either direction
+        bool attacking = false;                  // the direction; kept while it drains
+        int releasedSamples = 0;                 // how long the activity has been back at 1
+        int releaseDrainSamples = 0;             // after a release or attack ends: runs at zero weight
+
+        // Sized for a new kernel when the one above is too short or too long for it, and handed
+        // over with that kernel (guarded by kernelLock)
+        std::unique_ptr<PartitionedConvolver> pendingReleaseConvolver;
+        int pendingReleaseLayout = 0;
         
         IRSlot() 
         {
@@ -65,35 +211,247 @@ private:
         }
     };
 
+    //==============================================================================
+    /** Sum of the active slots' IRs, pre-mixed with the weights it was built for. */
+    struct CompositeIR
+    {
+        std::unique_ptr<PartitionedConvolver::Kernel> kernel;
+        std::vector<float> weights;
+        std::vector<juce::uint32> generations;
+    };
+
+    /**
+     * Every slot's kernel for the other shared layout, built off the audio thread when the host
+     * switches between realtime and offline rendering. Once the audio thread has swapped it in,
+     * it holds the outgoing layout's kernels until that convolver has rung out.
+     */
+    struct LayoutSwitch
+    {
+        int layoutIndex = 0;     // the sharedConvolvers entry the kernels are built for
+        bool nonRealtime = false;
+        std::vector<std::unique_ptr<PartitionedConvolver::Kernel>> kernels;         // one per slot
+        std::vector<std::unique_ptr<PartitionedConvolver::Kernel>> fadingKernels;   // one per slot
+        std::vector<juce::uint32> generations;
+        std::unique_ptr<CompositeIR> composite;
+
+        // Outgoing layout: the weights it rings out with, and which release convolvers ring out too
+        std::vector<float> weights;
+        std::vector<float> releaseWeights;   // two per slot
+        juce::uint32 releasingSlots = 0;
+        int drainSamples = 0;
+    };
+
+    /**
+     * Rebuilds the composite IR whenever the audio thread asks for a new weight set, and builds
+     * the other shared layout when the rendering mode changes.
+     */
+    class CompositeBuilder : public juce::Thread
+    {
+    public:
+        explicit CompositeBuilder(ConvolutionEngine& ownerEngine);
+        ~CompositeBuilder() override;
+        void run() override;
+
+    private:
+        ConvolutionEngine& owner;
+        juce::uint32 lastServedRequest = 0;
+        juce::uint32 lastServedLayoutRequest = 0;
+    };
+
+    /** Whatever the audio thread swapped out, waiting to be freed by the reclaimer. */
+    struct RetiredObjects
+    {
+        std::unique_ptr<juce::dsp::Convolution> convolution;
+        std::unique_ptr<PartitionedConvolver::Kernel> kernel;
+        std::unique_ptr<CompositeIR> composite;
+        std::unique_ptr<LayoutSwitch> layoutSwitch;
+        std::unique_ptr<PartitionedConvolver> releaseConvolver;
+    };
+
+    /** Frees retired objects once no tail job can still be reading them. */
+    class Reclaimer : public juce::Thread
+    {
+    public:
+        explicit Reclaimer(ConvolutionEngine& ownerEngine);
+        ~Reclaimer() override;
+        void run() override;
+
+    private:
+        ConvolutionEngine& owner;
+    };
+
     //==============================================================================
     // Core components
     std::vector<std::unique_ptr<IRSlot>> irSlots;
     
+    // Routing: one bit per slot in each mask, packed into a single word so every setter is one
+    // atomic read-modify-write and the audio thread reads a consistent set once per block
+    enum RoutingMask
+    {
+        loadedMask = 0,
+        mutedMask,
+        soloedMask,
+        invertedMask
+    };
+
+    std::atomic<juce::uint64> routing{ 0 };
+    juce::uint64 blockRouting = 0;   // audio thread: the snapshot the current block runs with
+
     // Master controls
     std::atomic<float> masterGain{ 1.0f };
     std::atomic<float> masterMix{ 1.0f };
     juce::LinearSmoothedValue<float> masterGainSmoother;
     juce::LinearSmoothedValue<float> masterMixSmoother;
 
-    // Processing buffers for efficiency
-    juce::AudioBuffer<float> dryBuffer;
+    // Processing buffers for efficiency (the dry signal is read straight from the host block)
     juce::AudioBuffer<float> wetBuffer;
-    juce::AudioBuffer<float> slotBuffer;
+    std::vector<const float*> inputChannels;
+    std::vector<float> wetGainRamp;   // master gain and mix, per sample
+    std::vector<float> dryGainRamp;
+
+    // Shared input-spectrum convolution: one convolver per layout, so the offline layout can be
+    // prepared while the realtime one plays, and swapped in between two blocks (and back)
+    std::array<PartitionedConvolver, 2> sharedConvolvers;
+    std::atomic<int> activeLayout{ 0 };   // written by the audio thread and prepare()
+    int kernelLayout = 0;                 // guarded by irDataLock: the layout new kernels are built for
+    std::unique_ptr<LayoutSwitch> pendingLayoutSwitch;   // guarded by kernelLock
+    std::unique_ptr<LayoutSwitch> outgoingLayout;        // guarded by drainLock
+    juce::SpinLock drainLock;             // the outgoing layout's ring-out against the builder re-preparing it
+    std::atomic<juce::uint32> layoutRequest{ 0 };
+    juce::AudioBuffer<float> silentInput; // what the outgoing layout hears while it rings out
+    std::vector<float> slotWeights;  // one per slot, the composite IR, then one outgoing kernel per slot
+    juce::uint32 sharedSlots = 0;    // audio thread: slots weighted into the convolver this block
+    std::vector<const float*> subBlockInputs;
+    std::vector<float*> subBlockOutputs;
+    juce::AudioBuffer<float> releaseOutput;
+    std::atomic<ProcessingMode> processingMode{ ProcessingMode::perSlot };
+    ProcessingMode activeProcessingMode = ProcessingMode::perSlot;
+    std::atomic<bool> nonRealtime{ false };
+    std::atomic<bool> preparedNonRealtime{ false };  // what the active layout was built for
+    std::atomic<bool> kernelsPending{ false };
+    juce::SpinLock kernelLock;
+    juce::CriticalSection irDataLock;
+    juce::CriticalSection loadLock;  // IR loads and clears (background loader) against prepare()
+
+    // Composite collapse: requests are published by the audio thread and served by compositeBuilder
+    std::unique_ptr<CompositeIR> activeComposite;   // audio thread
+    std::unique_ptr<CompositeIR> pendingComposite;  // guarded by kernelLock
+    bool hasPendingComposite = false;
+    std::vector<std::atomic<float>> requestedWeights;
+    std::vector<std::atomic<juce::uint32>> requestedGenerations;
+    std::atomic<juce::uint32> compositeRequest{ 0 };
+    std::vector<float> observedWeights;
+    int settledSamples = 0;
+    bool compositeRequested = false;
+    std::atomic<bool> usingComposite{ false };
+    std::atomic<bool> processingDualMono{ false };
+    int dualMonoSamples = 0;   // how long the input channels have matched
+    std::atomic<bool> sleeping{ false };
+    int silentSamples = 0;     // how long the input has been silent
+    RealtimeSignal builderSignal;   // composite and layout requests, and an outgoing layout rung out
+    CompositeBuilder compositeBuilder{ *this };
+
+    // Per-slot mode: slots to convolve this block, and the pool they may run on. A slot whose pool
+    // task overran its block is left alone until the task has finished, then restarts from silence
+    juce::uint32 queuedSlots = 0;
+    juce::uint32 overrunSlots = 0;   // audio thread
+    std::atomic<int> parallelSlotThreshold{ kDefaultParallelSlotThreshold };
+    std::atomic<bool> processingSlotsInParallel{ false };
+    SlotThreadPool slotPool;
+    juce::CriticalSection slotPoolLock;  // prepare() against the message thread restarting the pool
+    int slotPoolBlockSize = 0;           // guarded by slotPoolLock
+    double slotPoolSampleRate = 0.0;     // guarded by slotPoolLock
+
+    // Retirement queue: the audio thread is the only writer, the reclaimer the only reader
+    std::vector<RetiredObjects> retiredObjects;
+    juce::AbstractFifo retirementFifo{ kRetirementQueueSize };
+    RealtimeSignal reclaimSignal;
+    Reclaimer reclaimer{ *this };
 
     // Audio format settings
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
     int numChannels = 2;
+    int maxIRLength = 0;
+    int crossfadeSamples = 0;
 
     // Performance constants
     static constexpr float kSmoothingTimeMs = 20.0f;
+    static constexpr float kMuteRampMs = 20.0f;         // mute/solo ramp before a slot's tail rings out
     static constexpr float kMinGain = 0.000001f; // ~-120dB for deeper attenuation
+    static constexpr float kCompositeSettleMs = 150.0f; // parameters must hold this long before collapsing
+    static constexpr float kIRCrossfadeMs = 30.0f;      // equal-power fade between an outgoing and a new IR
+    static constexpr float kIdenticalChannelTolerance = 1.0e-6f; // stereo IRs closer than this are run as mono
+    static constexpr float kDualMonoTolerance = 1.0e-6f;         // input channels closer than this are convolved once
+    static constexpr float kSilenceThreshold = 1.0e-5f;          // ~-100dB: input below this counts as silence
+    static constexpr int kMaxRunCount = 1 << 16;                 // headroom above maxIRLength for the run counters
+    static constexpr int kRetirementQueueSize = 64;              // swaps wait a block if the reclaimer falls this far behind
+    static constexpr int kLayoutRetryMs = 20;                    // a layout switch waiting on the last one's ring-out
+    static constexpr int kRoutingMaskBits = 16;                 // slots per routing mask (4 masks per word)
+    static constexpr int kDefaultParallelSlotThreshold = 1024;  // below this, waking workers costs more than it saves
+    static constexpr int kWeightUpdateSamples = 64;             // shared modes: step size of a moving kernel weight
     
     //==============================================================================
     // Helper methods
+    void processChunk(const juce::dsp::ProcessContextReplacing<float>& context);
     void updateSmoothers();
-    bool hasAnySoloedSlots() const;
-    void processSlot(int slotIndex, const juce::dsp::ProcessContextReplacing<float>& context);
+    void applyMasterSection(const juce::dsp::AudioBlock<float>& outputBlock, int numSamples,
+                            bool hasActiveIR, bool hasAnyLoadedIR);
+    void setRoutingBit(RoutingMask mask, int slotIndex, bool shouldBeSet) noexcept;
+    bool isRoutingBitSet(RoutingMask mask, int slotIndex) const noexcept;
+    static juce::uint32 getRoutingMask(juce::uint64 snapshot, RoutingMask mask) noexcept
+    {
+        return static_cast<juce::uint32>((snapshot >> (static_cast<int>(mask) * kRoutingMaskBits)) & 0xffffu);
+    }
+    bool isSlotInverted(int slotIndex) const noexcept { return ((getRoutingMask(blockRouting, invertedMask) >> slotIndex) & 1u) != 0; }
+    bool updateSlotActivity(IRSlot& slot, bool shouldPlay, int numSamples);
+    void startRelease(IRSlot& slot, bool attack);
+    void stopRelease(IRSlot& slot);
+    void processReleases(int numChannelsToProcess, int start, int numSamples);
+    void drainOutgoingLayout(int numSamples, bool stillAudible);
+    void clearLayoutKernels(int layoutIndex);
+    bool runSlot(int slotIndex, bool useSharedSpectrum, int numSamples);
+    bool convolveQueuedSlots(const juce::dsp::ProcessContextReplacing<float>& context);
+    void updateSlotPool();
+    void recoverOverrunSlots();
+    bool stageSlotInput(IRSlot& slot, const juce::dsp::AudioBlock<const float>& hostInput, int numSamples, bool alwaysCopy);
+    void processSlot(int slotIndex, const juce::dsp::AudioBlock<const float>& hostInput, int numSamples, bool inputStaged);
+    void processSharedSpectrum(const juce::dsp::ProcessContextReplacing<float>& context);
+    bool isDualMonoInput(int numChannelsToCheck, int numSamples) const;
+    bool isSilentInput(int numSamples) const;
+    bool hasOutlastedTail(int tailLength, int numSamples) const { return silentSamples >= tailLength + numSamples; }
+    void adoptPendingKernels();
+    bool adoptLayoutSwitch();
+    bool adoptPendingConvolution(IRSlot& slot);
+    bool adoptPendingKernel(int slotIndex);
+    void setSharedSlotWeight(int slotIndex, float gain, float activity, int offset, int numSamples);
+    void updateSharedSlotWeights(int offset, int numSamples);
+    bool areSharedSlotWeightsMoving() const;
+    void advanceCrossfades(int numSamples);
+    bool canRetire(int numObjects) const noexcept { return retirementFifo.getFreeSpace() >= numObjects; }
+    void retire(RetiredObjects&& objects) noexcept;
+    void reclaimRetiredObjects();
+    static bool fillRamp(juce::LinearSmoothedValue<float>& smoother, float* ramp, int numSamples, float scale) noexcept;
+    static float advanceRamp(juce::LinearSmoothedValue<float>& smoother, int numSamples) noexcept;
+    static float getCrossfadeProgress(int remaining, int length, int numSamples);
+    std::unique_ptr<juce::dsp::Convolution> createSlotConvolution(const juce::AudioBuffer<float>& irBuffer) const;
+    void queueSlotConvolution(int slotIndex, std::unique_ptr<juce::dsp::Convolution> convolution);
+    int getFadingKernelIndex(int slotIndex) const { return static_cast<int>(irSlots.size()) + 1 + slotIndex; }
+    void rebuildSharedKernels();
+    bool buildLayoutSwitch(); // false while the target layout is still ringing out
+    PartitionedConvolver& getSharedConvolver() noexcept { return sharedConvolvers[getActiveLayout()]; }
+    size_t getActiveLayout() const noexcept { return static_cast<size_t>(activeLayout.load(std::memory_order_relaxed)); }
+    static PartitionedConvolver::Layout getLayoutForMode(ProcessingMode mode, bool renderingOffline);
+    static SlotPath getPathForKernel(const PartitionedConvolver::Kernel* kernel);
+    void queueSharedKernel(int slotIndex, std::unique_ptr<PartitionedConvolver::Kernel> kernel, juce::uint32 generation,
+                           std::unique_ptr<PartitionedConvolver> releaseConvolver = nullptr);
+    std::unique_ptr<PartitionedConvolver> createReleaseConvolver(int slotIndex, int irLength);
+    int getHeldKernelLength(int slotIndex) const;
+    void updateComposite(bool weightsSettled, int numSamples);
+    bool compositeMatches(const CompositeIR& composite) const;
+    void buildComposite();
+    static juce::AudioBuffer<float> makeDistinctChannelIR(const juce::AudioBuffer<float>& irBuffer);
+    static juce::AudioBuffer<float> conditionImpulseResponse(const juce::AudioBuffer<float>& irBuffer);
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionEngine)
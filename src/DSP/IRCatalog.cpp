@@ -0,0 +1,238 @@
+#include "IRCatalog.h"
+
+//==============================================================================
+IRCatalog::IRCatalog()
+    : IRCatalog(getDefaultCatalogFile())
+{
+}
+
+IRCatalog::IRCatalog(const juce::File& catalogFileToUse)
+    : catalogFile(catalogFileToUse)
+{
+    load();
+}
+
+juce::File IRCatalog::getDefaultCatalogFile()
+{
+    // Per user: the IR collection itself usually lives somewhere read-only
+    auto directory = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory);
+
+   #if JUCE_MAC
+    directory = directory.getChildFile("Application Support");
+   #endif
+
+    return directory.getChildFile("King Studios")
+                    .getChildFile("The Kings Cab")
+                    .getChildFile("IRCatalog.bin");
+}
+
+//==============================================================================
+bool IRCatalog::findDirectory(const juce::File& directory, DirectoryRecord& result) const
+{
+    const juce::ScopedLock sl(lock);
+
+    auto record = directories.find(directory.getFullPathName());
+    if (record == directories.end())
+        return false;
+
+    result = record->second;
+    return true;
+}
+
+void IRCatalog::storeDirectory(const juce::File& directory, DirectoryRecord record)
+{
+    const juce::ScopedLock sl(lock);
+
+    directories[directory.getFullPathName()] = std::move(record);
+    changed = true;
+}
+
+//==============================================================================
+void IRCatalog::load()
+{
+    if (!catalogFile.existsAsFile())
+        return;
+
+    juce::MemoryMappedFile mappedFile(catalogFile, juce::MemoryMappedFile::readOnly);
+    if (mappedFile.getData() == nullptr)
+        return;
+
+    // Header: magic, version, payload size and checksum. Reads past the end return zeros,
+    // so a truncated or damaged file is only caught by checking the payload as a whole.
+    juce::MemoryInputStream header(mappedFile.getData(), mappedFile.getSize(), false);
+
+    if (header.readInt() != kMagic || header.readInt() != kVersion)
+    {
+        DBG("IRCatalog: Ignoring catalog from another version: " << catalogFile.getFullPathName());
+        return;
+    }
+
+    const auto payloadSize = header.readInt64();
+    const auto checksum = static_cast<juce::uint64>(header.readInt64());
+    const auto* payload = static_cast<const char*>(mappedFile.getData()) + header.getPosition();
+
+    if (payloadSize != header.getNumBytesRemaining() || computeChecksum(payload, static_cast<size_t>(payloadSize)) != checksum)
+    {
+        DBG("IRCatalog: Ignoring damaged catalog: " << catalogFile.getFullPathName());
+        return;
+    }
+
+    juce::MemoryInputStream in(payload, static_cast<size_t>(payloadSize), false);
+
+    // Every entry takes at least a byte, so a count beyond that means a damaged file
+    auto readCount = [&in]
+    {
+        const auto count = in.readInt();
+        return (count >= 0 && count <= in.getNumBytesRemaining()) ? count : -1;
+    };
+
+    std::map<juce::String, DirectoryRecord> loaded;
+    const auto numDirectories = readCount();
+
+    for (int d = 0; d < numDirectories; ++d)
+    {
+        auto path = in.readString();
+        DirectoryRecord record;
+        record.modificationTime = in.readInt64();
+
+        const auto numSubdirectories = readCount();
+        if (numSubdirectories < 0)
+            break;
+
+        for (int s = 0; s < numSubdirectories; ++s)
+            record.subdirectories.add(in.readString());
+
+        const auto numFiles = readCount();
+        if (numFiles < 0)
+            break;
+
+        record.files.reserve(static_cast<size_t>(numFiles));
+        for (int f = 0; f < numFiles; ++f)
+        {
+            FileRecord file;
+            file.fileName = in.readString();
+            file.size = in.readInt64();
+            file.modificationTime = in.readInt64();
+            file.sampleRate = in.readDouble();
+            file.lengthInSamples = in.readInt();
+            file.numChannels = in.readInt();
+            file.isValid = in.readBool();
+            record.files.push_back(std::move(file));
+        }
+
+        loaded.emplace(std::move(path), std::move(record));
+    }
+
+    if (numDirectories < 0 || static_cast<int>(loaded.size()) != numDirectories || in.getPosition() != in.getTotalLength())
+    {
+        DBG("IRCatalog: Ignoring damaged catalog: " << catalogFile.getFullPathName());
+        return;
+    }
+
+    const juce::ScopedLock sl(lock);
+    directories = std::move(loaded);
+    DBG("IRCatalog: Loaded " << static_cast<int>(directories.size()) << " directories from " << catalogFile.getFullPathName());
+}
+
+void IRCatalog::saveIfChanged()
+{
+    // One writer at a time, so an older snapshot never replaces a newer one on disk
+    const juce::ScopedLock writing(saveLock);
+
+    // Copied under the lock; the stats and the write below don't hold up scan jobs
+    std::map<juce::String, DirectoryRecord> snapshot;
+
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (!changed)
+            return;
+
+        changed = false;
+        snapshot = directories;
+    }
+
+    // Only ever written after a scan, so this is the place to forget deleted folders
+    juce::StringArray deletedDirectories;
+
+    for (auto record = snapshot.begin(); record != snapshot.end();)
+    {
+        if (juce::File(record->first).isDirectory())
+        {
+            ++record;
+        }
+        else
+        {
+            deletedDirectories.add(record->first);
+            record = snapshot.erase(record);
+        }
+    }
+
+    if (!deletedDirectories.isEmpty())
+    {
+        const juce::ScopedLock sl(lock);
+
+        for (const auto& path : deletedDirectories)
+            directories.erase(path);
+    }
+
+    juce::MemoryOutputStream out;
+    out.writeInt(static_cast<int>(snapshot.size()));
+
+    for (const auto& [path, record] : snapshot)
+    {
+        out.writeString(path);
+        out.writeInt64(record.modificationTime);
+
+        out.writeInt(record.subdirectories.size());
+        for (const auto& subdirectory : record.subdirectories)
+            out.writeString(subdirectory);
+
+        out.writeInt(static_cast<int>(record.files.size()));
+        for (const auto& file : record.files)
+        {
+            out.writeString(file.fileName);
+            out.writeInt64(file.size);
+            out.writeInt64(file.modificationTime);
+            out.writeDouble(file.sampleRate);
+            out.writeInt(file.lengthInSamples);
+            out.writeInt(file.numChannels);
+            out.writeBool(file.isValid);
+        }
+    }
+
+    juce::MemoryOutputStream file;
+    file.writeInt(kMagic);
+    file.writeInt(kVersion);
+    file.writeInt64(static_cast<juce::int64>(out.getDataSize()));
+    file.writeInt64(static_cast<juce::int64>(computeChecksum(out.getData(), out.getDataSize())));
+    file.write(out.getData(), out.getDataSize());
+
+    // Written beside the target and moved over it, so other instances never read half a file
+    catalogFile.getParentDirectory().createDirectory();
+    juce::TemporaryFile temporary(catalogFile);
+
+    if (temporary.getFile().replaceWithData(file.getData(), file.getDataSize())
+        && temporary.overwriteTargetFileWithTemporary())
+    {
+        DBG("IRCatalog: Saved " << static_cast<int>(file.getDataSize()) << " bytes to " << catalogFile.getFullPathName());
+    }
+    else
+    {
+        DBG("IRCatalog: Could not write " << catalogFile.getFullPathName());
+    }
+}
+
+juce::uint64 IRCatalog::computeChecksum(const void* data, size_t numBytes) noexcept
+{
+    // 64-bit FNV-1a: only has to catch truncation and stray writes, not tampering
+    juce::uint64 hash = 14695981039346656037ull;
+
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        hash ^= static_cast<const juce::uint8*>(data)[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include <vector>
+
+//==============================================================================
+/**
+ * Persistent catalog of probed IR files for The King's Cab
+ *
+ * Handles:
+ * - One record per scanned directory: its modification time, subdirectories and files
+ * - Per-file format info (rate, length, channels, validity) keyed by name, size and mtime
+ * - Loading the whole catalog with one memory-mapped read, and saving it atomically
+ *
+ * A directory whose modification time is unchanged is taken from the catalog without being
+ * listed again (adding, removing or renaming a file changes it), though each of its files is
+ * still stat'ed, since rewriting a file in place doesn't. Either way, only files whose size
+ * or mtime differ are probed again.
+ *
+ * Shared by every plugin instance through a SharedResourcePointer; all calls are thread-safe.
+ */
+class IRCatalog
+{
+public:
+    //==============================================================================
+    struct FileRecord
+    {
+        juce::String fileName;
+        juce::int64 size = 0;
+        juce::int64 modificationTime = 0;
+        double sampleRate = 0.0;
+        int lengthInSamples = 0;
+        int numChannels = 0;
+        bool isValid = false;
+    };
+
+    struct DirectoryRecord
+    {
+        juce::int64 modificationTime = 0;
+        juce::StringArray subdirectories;
+        std::vector<FileRecord> files;   // every IR candidate, valid or not, so neither is probed twice
+    };
+
+    //==============================================================================
+    IRCatalog();
+    explicit IRCatalog(const juce::File& catalogFileToUse);
+
+    //==============================================================================
+    // A copy of the directory's record, if there is one. Doesn't check it is up to date.
+    bool findDirectory(const juce::File& directory, DirectoryRecord& result) const;
+    void storeDirectory(const juce::File& directory, DirectoryRecord record);
+
+    // Writes the catalog if anything changed since it was loaded or last saved. The records are
+    // copied under the lock and written outside it, so scan jobs can keep storing meanwhile.
+    void saveIfChanged();
+
+    const juce::File& getCatalogFile() const noexcept { return catalogFile; }
+    static juce::File getDefaultCatalogFile();
+
+private:
+    //==============================================================================
+    juce::File catalogFile;
+    std::map<juce::String, DirectoryRecord> directories;   // keyed by full path
+    bool changed = false;
+    mutable juce::CriticalSection lock;
+    juce::CriticalSection saveLock;   // held for a whole save, never together with the scan's locks
+
+    static constexpr juce::int32 kMagic = 0x4b434943;   // "KCIC"
+    static constexpr juce::int32 kVersion = 1;
+
+    //==============================================================================
+    void load();
+    static juce::uint64 computeChecksum(const void* data, size_t numBytes) noexcept;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(IRCatalog)
+};
@@ -0,0 +1,269 @@
+#include "IRFileHeader.h"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // Chunk IDs as read by InputStream::readInt(), which is little-endian
+    constexpr juce::uint32 chunkName(const char (&name)[5]) noexcept
+    {
+        return static_cast<juce::uint32>(static_cast<juce::uint8>(name[0]))
+             | static_cast<juce::uint32>(static_cast<juce::uint8>(name[1])) << 8
+             | static_cast<juce::uint32>(static_cast<juce::uint8>(name[2])) << 16
+             | static_cast<juce::uint32>(static_cast<juce::uint8>(name[3])) << 24;
+    }
+
+    constexpr int kWaveFormatPCM = 0x0001;
+    constexpr int kWaveFormatFloat = 0x0003;
+    constexpr int kWaveFormatExtensible = 0xfffe;
+
+    // Bytes 2-15 of the KSDATAFORMAT_SUBTYPE GUIDs; bytes 0-1 hold the format tag
+    constexpr juce::uint8 kSubFormatGuidTail[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80,
+                                                     0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 };
+
+    bool isPlainIntegerDepth(int bitsPerSample) noexcept
+    {
+        return bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32;
+    }
+}
+
+//==============================================================================
+std::optional<IRFileHeader> IRFileHeader::read(const juce::File& file)
+{
+    const bool isWav = file.hasFileExtension("wav");
+    const bool isAiff = file.hasFileExtension("aif;aiff");
+    const bool isFlac = file.hasFileExtension("flac");
+
+    if (!isWav && !isAiff && !isFlac)
+        return std::nullopt;
+
+    juce::FileInputStream fileStream(file);
+    if (!fileStream.openedOk())
+        return std::nullopt;
+
+    juce::BufferedInputStream in(fileStream, kReadBufferSize);
+
+    if (isWav)
+        return readWav(in);
+
+    if (isAiff)
+        return readAiff(in);
+
+    return readFlac(in);
+}
+
+//==============================================================================
+std::optional<IRFileHeader> IRFileHeader::readWav(juce::InputStream& in)
+{
+    const auto riffType = static_cast<juce::uint32>(in.readInt());
+
+    if (riffType == chunkName("RF64"))
+        return std::nullopt;
+
+    in.readInt(); // RIFF size: often wrong, and the chunks say everything needed
+
+    if (riffType != chunkName("RIFF") || static_cast<juce::uint32>(in.readInt()) != chunkName("WAVE"))
+        return IRFileHeader();
+
+    IRFileHeader header;
+    int bytesPerFrame = 0;
+    juce::int64 dataSize = -1;
+
+    while ((bytesPerFrame == 0 || dataSize < 0) && in.getNumBytesRemaining() >= 8)
+    {
+        const auto chunkType = static_cast<juce::uint32>(in.readInt());
+        const auto chunkSize = static_cast<juce::int64>(static_cast<juce::uint32>(in.readInt()));
+        const auto chunkStart = in.getPosition();
+
+        if (chunkType == chunkName("fmt "))
+        {
+            if (chunkSize < 16)
+                return std::nullopt;
+
+            int formatTag = static_cast<juce::uint16>(in.readShort());
+            header.numChannels = static_cast<juce::uint16>(in.readShort());
+            header.sampleRate = static_cast<juce::uint32>(in.readInt());
+            in.readInt(); // bytes per second
+            const int blockAlign = static_cast<juce::uint16>(in.readShort());
+            const int bitsPerSample = static_cast<juce::uint16>(in.readShort());
+
+            if (formatTag == kWaveFormatExtensible)
+            {
+                juce::uint8 subFormat[16];
+
+                if (chunkSize < 40)
+                    return std::nullopt;
+
+                in.skipNextBytes(8); // extension size, valid bits, channel mask
+
+                if (in.read(subFormat, sizeof(subFormat)) != static_cast<int>(sizeof(subFormat))
+                    || std::memcmp(subFormat + 2, kSubFormatGuidTail, sizeof(kSubFormatGuidTail)) != 0)
+                    return std::nullopt;
+
+                formatTag = subFormat[0] | (subFormat[1] << 8);
+            }
+
+            const bool isPlainEncoding = (formatTag == kWaveFormatPCM && isPlainIntegerDepth(bitsPerSample))
+                                      || (formatTag == kWaveFormatFloat && bitsPerSample == 32);
+
+            // Padded or packed frames are left to the reader
+            bytesPerFrame = header.numChannels * bitsPerSample / 8;
+            if (!isPlainEncoding || header.numChannels == 0 || blockAlign != bytesPerFrame)
+                return std::nullopt;
+        }
+        else if (chunkType == chunkName("data"))
+        {
+            // Streamed recordings leave the size at 0 or 0xffffffff; the reader copes with those
+            if (chunkSize == 0 || chunkStart + chunkSize > in.getTotalLength())
+                return std::nullopt;
+
+            dataSize = chunkSize;
+        }
+
+        // Chunks are word-aligned
+        if (!in.setPosition(chunkStart + chunkSize + (chunkSize & 1)))
+            break;
+    }
+
+    if (bytesPerFrame == 0 || dataSize < 0)
+        return std::nullopt;
+
+    header.lengthInSamples = dataSize / bytesPerFrame;
+    return header;
+}
+
+std::optional<IRFileHeader> IRFileHeader::readAiff(juce::InputStream& in)
+{
+    const auto magic = static_cast<juce::uint32>(in.readInt());
+    in.readIntBigEndian(); // FORM size
+
+    const auto formType = static_cast<juce::uint32>(in.readInt());
+    const bool isAifc = formType == chunkName("AIFC");
+
+    if (magic != chunkName("FORM") || (formType != chunkName("AIFF") && !isAifc))
+        return IRFileHeader();
+
+    IRFileHeader header;
+    bool foundSoundData = false;
+
+    while ((header.numChannels == 0 || !foundSoundData) && in.getNumBytesRemaining() >= 8)
+    {
+        const auto chunkType = static_cast<juce::uint32>(in.readInt());
+        const auto chunkSize = static_cast<juce::int64>(static_cast<juce::uint32>(in.readIntBigEndian()));
+        const auto chunkStart = in.getPosition();
+
+        if (chunkType == chunkName("COMM"))
+        {
+            juce::uint8 sampleRate[10];
+
+            if (chunkSize < (isAifc ? 22 : 18))
+                return std::nullopt;
+
+            const int numChannels = static_cast<juce::uint16>(in.readShortBigEndian());
+            const auto numFrames = static_cast<juce::uint32>(in.readIntBigEndian());
+            const int bitsPerSample = static_cast<juce::uint16>(in.readShortBigEndian());
+
+            if (in.read(sampleRate, sizeof(sampleRate)) != static_cast<int>(sizeof(sampleRate)))
+                return std::nullopt;
+
+            bool isPlainEncoding = isPlainIntegerDepth(bitsPerSample);
+
+            if (isAifc)
+            {
+                const auto compression = static_cast<juce::uint32>(in.readInt());
+
+                if (compression == chunkName("fl32") || compression == chunkName("FL32"))
+                    isPlainEncoding = bitsPerSample == 32;
+                else if (compression != chunkName("NONE") && compression != chunkName("twos") && compression != chunkName("sowt"))
+                    isPlainEncoding = false;
+            }
+
+            header.sampleRate = readExtendedFloat(sampleRate);
+
+            if (!isPlainEncoding || numChannels == 0 || !(header.sampleRate > 0.0))
+                return std::nullopt;
+
+            header.numChannels = numChannels;
+            header.lengthInSamples = numFrames;
+        }
+        else if (chunkType == chunkName("SSND"))
+        {
+            foundSoundData = true;
+        }
+
+        if (!in.setPosition(chunkStart + chunkSize + (chunkSize & 1)))
+            break;
+    }
+
+    if (header.numChannels == 0 || !foundSoundData)
+        return std::nullopt;
+
+    return header;
+}
+
+std::optional<IRFileHeader> IRFileHeader::readFlac(juce::InputStream& in)
+{
+    juce::uint8 bytes[10];
+
+    if (in.read(bytes, 4) != 4)
+        return std::nullopt;
+
+    // Some taggers put an ID3v2 tag in front of the stream
+    if (std::memcmp(bytes, "ID3", 3) == 0)
+    {
+        if (in.read(bytes + 4, 6) != 6)
+            return std::nullopt;
+
+        const auto tagSize = (bytes[6] & 0x7f) << 21 | (bytes[7] & 0x7f) << 14 | (bytes[8] & 0x7f) << 7 | (bytes[9] & 0x7f);
+        const auto footerSize = (bytes[5] & 0x10) != 0 ? 10 : 0;
+
+        if (!in.setPosition(10 + tagSize + footerSize) || in.read(bytes, 4) != 4)
+            return std::nullopt;
+    }
+
+    if (std::memcmp(bytes, "fLaC", 4) != 0)
+        return std::nullopt;
+
+    // STREAMINFO is always the first metadata block: 4-byte block header, then 34 bytes
+    juce::uint8 streamInfo[22];
+
+    if (in.read(streamInfo, sizeof(streamInfo)) != static_cast<int>(sizeof(streamInfo))
+        || (streamInfo[0] & 0x7f) != 0)
+        return std::nullopt;
+
+    // After the block sizes: 20 bits rate, 3 bits channels - 1, 5 bits depth - 1, 36 bits samples
+    const auto* packed = streamInfo + 4 + 10;
+
+    IRFileHeader header;
+    header.sampleRate = packed[0] << 12 | packed[1] << 4 | packed[2] >> 4;
+    header.numChannels = ((packed[2] >> 1) & 0x07) + 1;
+    const int bitsPerSample = ((packed[2] & 0x01) << 4 | packed[3] >> 4) + 1;
+    header.lengthInSamples = static_cast<juce::int64>(packed[3] & 0x0f) << 32
+                           | static_cast<juce::int64>(packed[4]) << 24
+                           | static_cast<juce::int64>(packed[5]) << 16
+                           | static_cast<juce::int64>(packed[6]) << 8
+                           | static_cast<juce::int64>(packed[7]);
+
+    // An unknown total (0) or an unusual depth is left to the reader
+    if (header.sampleRate <= 0.0 || header.lengthInSamples == 0 || bitsPerSample < 8 || bitsPerSample > 24)
+        return std::nullopt;
+
+    return header;
+}
+
+double IRFileHeader::readExtendedFloat(const juce::uint8* bytes) noexcept
+{
+    // 80-bit IEEE 754 extended, big-endian: sign and 15-bit exponent, then a 64-bit mantissa
+    // with an explicit integer bit
+    const int exponent = (bytes[0] & 0x7f) << 8 | bytes[1];
+    juce::uint64 mantissa = 0;
+
+    for (int i = 2; i < 10; ++i)
+        mantissa = mantissa << 8 | bytes[i];
+
+    if (exponent == 0x7fff)
+        return 0.0;
+
+    const auto value = std::ldexp(static_cast<double>(mantissa), exponent - 16383 - 63);
+    return (bytes[0] & 0x80) != 0 ? -value : value;
+}
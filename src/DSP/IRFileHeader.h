@@ -0,0 +1,43 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <optional>
+
+//==============================================================================
+/**
+ * Header-only format probe for IR files in The King's Cab
+ *
+ * Handles:
+ * - RIFF/WAVE: plain and extensible PCM (8/16/24/32-bit) and 32-bit float
+ * - AIFF and AIFC: uncompressed ("NONE", "twos", "sowt") and 32-bit float ("fl32")
+ * - FLAC: the STREAMINFO block, behind an optional ID3v2 tag
+ *
+ * Reads the sample rate, length and channel count from the first few KB of the file
+ * without building an AudioFormatManager or AudioFormatReader. Anything else (compressed
+ * encodings, RF64, streamed WAVs without a data size, damaged headers) returns nothing,
+ * and callers fall back to a full reader, which has the final say.
+ *
+ * A .wav or .aiff without the right magic number can't be opened by JUCE's reader either,
+ * so it comes back as an empty header (no channels) instead of costing a reader.
+ */
+class IRFileHeader
+{
+public:
+    //==============================================================================
+    double sampleRate = 0.0;
+    juce::int64 lengthInSamples = 0;
+    int numChannels = 0;
+
+    // The file's header, if it is one of the formats above; chosen by extension like JUCE's readers
+    static std::optional<IRFileHeader> read(const juce::File& file);
+
+private:
+    //==============================================================================
+    static std::optional<IRFileHeader> readWav(juce::InputStream& in);
+    static std::optional<IRFileHeader> readAiff(juce::InputStream& in);
+    static std::optional<IRFileHeader> readFlac(juce::InputStream& in);
+    static double readExtendedFloat(const juce::uint8* bytes) noexcept;
+
+    // Enough for the format chunks of nearly every IR; anything further costs one more read
+    static constexpr int kReadBufferSize = 4096;
+};
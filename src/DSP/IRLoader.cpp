@@ -0,0 +1,211 @@
+#include "IRLoader.h"
+
+//==============================================================================
+IRLoader::IRLoader(IRManager& manager, ConvolutionEngine& engine, int numSlots)
+    : juce::Thread("KingsCab IR Loader"),
+      irManager(manager),
+      convolutionEngine(engine),
+      requests(static_cast<size_t>(numSlots))
+{
+    startThread();
+}
+
+IRLoader::~IRLoader()
+{
+    // A load in flight finishes its current stage; anything still queued is dropped
+    signalThreadShouldExit();
+    notify();
+    stopThread(kStopTimeoutMs);
+
+    cancelPendingUpdate();
+}
+
+//==============================================================================
+void IRLoader::requestLoad(int slotIndex, const juce::File& irFile)
+{
+    queueRequest(slotIndex, irFile);
+}
+
+void IRLoader::requestClear(int slotIndex)
+{
+    queueRequest(slotIndex, juce::File());
+}
+
+void IRLoader::queueRequest(int slotIndex, const juce::File& irFile)
+{
+    if (slotIndex < 0 || slotIndex >= static_cast<int>(requests.size()))
+        return;
+
+    {
+        const juce::ScopedLock lock(requestLock);
+        auto& request = requests[static_cast<size_t>(slotIndex)];
+        request.file = irFile;
+        request.requestTime = juce::Time::getMillisecondCounter();
+        ++request.generation;
+    }
+
+    notify();
+}
+
+juce::File IRLoader::getRequestedIR(int slotIndex) const
+{
+    if (slotIndex < 0 || slotIndex >= static_cast<int>(requests.size()))
+        return {};
+
+    {
+        const juce::ScopedLock lock(requestLock);
+        const auto& request = requests[static_cast<size_t>(slotIndex)];
+        if (request.generation != request.servedGeneration)
+            return request.file;
+    }
+
+    return irManager.getLoadedIR(slotIndex);
+}
+
+bool IRLoader::waitUntilIdle(int timeoutMs) const
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(juce::jmax(0, timeoutMs));
+
+    // Loads finish in tens of milliseconds, so polling is simpler than a second wake-up path
+    while (hasPendingWork())
+    {
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+
+        juce::Thread::sleep(kIdlePollMs);
+    }
+
+    return true;
+}
+
+bool IRLoader::hasPendingWork() const
+{
+    const juce::ScopedLock lock(requestLock);
+
+    if (servingSlot >= 0)
+        return true;
+
+    for (const auto& request : requests)
+        if (request.generation != request.servedGeneration)
+            return true;
+
+    return false;
+}
+
+//==============================================================================
+void IRLoader::run()
+{
+    while (!threadShouldExit())
+    {
+        int slotIndex = -1;
+        int msUntilNext = -1;
+        SlotRequest request;
+
+        if (!takeNextRequest(slotIndex, request, msUntilNext))
+        {
+            // Nothing ready: sleep until the next burst settles or a new request arrives
+            wait(msUntilNext);
+            continue;
+        }
+
+        serveRequest(slotIndex, request);
+
+        const juce::ScopedLock lock(requestLock);
+        servingSlot = -1;
+    }
+}
+
+bool IRLoader::takeNextRequest(int& slotIndex, SlotRequest& request, int& msUntilNext)
+{
+    const juce::ScopedLock lock(requestLock);
+    const auto now = juce::Time::getMillisecondCounter();
+
+    msUntilNext = -1;
+
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        auto& slotRequest = requests[i];
+        if (slotRequest.generation == slotRequest.servedGeneration)
+            continue;
+
+        // Keep coalescing while the user is still clicking through IRs
+        const auto age = static_cast<int>(now - slotRequest.requestTime);
+        if (slotRequest.file != juce::File() && age < kCoalesceMs)
+        {
+            const auto remaining = kCoalesceMs - age;
+            msUntilNext = msUntilNext < 0 ? remaining : juce::jmin(msUntilNext, remaining);
+            continue;
+        }
+
+        slotRequest.servedGeneration = slotRequest.generation;
+        servingSlot = static_cast<int>(i);
+        slotIndex = static_cast<int>(i);
+        request = slotRequest;
+        return true;
+    }
+
+    return false;
+}
+
+bool IRLoader::isSuperseded(int slotIndex, juce::uint32 generation) const
+{
+    const juce::ScopedLock lock(requestLock);
+    return requests[static_cast<size_t>(slotIndex)].generation != generation;
+}
+
+void IRLoader::serveRequest(int slotIndex, const SlotRequest& request)
+{
+    if (request.file == juce::File())
+    {
+        irManager.clearIR(slotIndex);
+        convolutionEngine.clearImpulseResponse(slotIndex);
+        postCompletion(slotIndex, {}, true);
+        return;
+    }
+
+    // Decode and trim without touching the slot, so a superseded result can simply be dropped
+    auto buffer = std::make_unique<juce::AudioBuffer<float>>();
+    IRManager::IRInfo info;
+
+    if (!irManager.readIR(request.file, *buffer, info))
+    {
+        if (!isSuperseded(slotIndex, request.generation))
+            postCompletion(slotIndex, request.file, false);
+        return;
+    }
+
+    if (threadShouldExit() || isSuperseded(slotIndex, request.generation))
+        return;
+
+    // Convolution preparation is the expensive part; once it has run the result is kept,
+    // and a newer request simply crossfades over it
+    const bool success = convolutionEngine.loadImpulseResponse(slotIndex, *buffer);
+    if (success)
+        irManager.storeIR(slotIndex, std::move(buffer), info);
+
+    if (!isSuperseded(slotIndex, request.generation))
+        postCompletion(slotIndex, request.file, success);
+}
+
+//==============================================================================
+void IRLoader::postCompletion(int slotIndex, const juce::File& irFile, bool success)
+{
+    {
+        const juce::ScopedLock lock(completionLock);
+        completions.push_back({ slotIndex, irFile, success });
+    }
+
+    triggerAsyncUpdate();
+}
+
+void IRLoader::handleAsyncUpdate()
+{
+    std::vector<Completion> finished;
+    {
+        const juce::ScopedLock lock(completionLock);
+        finished.swap(completions);
+    }
+
+    for (const auto& completion : finished)
+        listeners.call([&completion](Listener& l) { l.irLoadFinished(completion.slotIndex, completion.file, completion.success); });
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "IRManager.h"
+#include "ConvolutionEngine.h"
+
+//==============================================================================
+/**
+ * Background IR loader for The King's Cab
+ *
+ * Handles:
+ * - Decoding, trimming and convolution preparation off the message thread
+ * - Per-slot request coalescing: a burst of requests only honours the latest one
+ * - Cancellation of superseded work before it reaches the convolution engine
+ * - Completion notifications delivered to listeners on the message thread
+ *
+ * Clears go through the same queue, so a slot's loads and clears always apply in
+ * the order they were requested.
+ */
+class IRLoader : private juce::Thread,
+                 private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        // Called on the message thread once the latest request for a slot has been applied.
+        // irFile is empty for a clear; superseded requests never report.
+        virtual void irLoadFinished(int slotIndex, const juce::File& irFile, bool success) = 0;
+    };
+
+    //==============================================================================
+    IRLoader(IRManager& manager, ConvolutionEngine& engine, int numSlots);
+    ~IRLoader() override;
+
+    //==============================================================================
+    // Requests (any non-audio thread); each one supersedes anything still queued or
+    // in flight for the same slot
+    void requestLoad(int slotIndex, const juce::File& irFile);
+    void requestClear(int slotIndex);
+
+    // The file a slot will hold once its queued work is done (the loaded one if nothing is queued)
+    juce::File getRequestedIR(int slotIndex) const;
+
+    // Blocks until every queued and in-flight request has been applied to the engine, or the
+    // timeout passes. Only for offline rendering, where the audio thread may wait; returns
+    // true if the loader went idle.
+    bool waitUntilIdle(int timeoutMs) const;
+
+    //==============================================================================
+    void addListener(Listener* listener) { listeners.add(listener); }
+    void removeListener(Listener* listener) { listeners.remove(listener); }
+
+private:
+    //==============================================================================
+    struct SlotRequest
+    {
+        juce::File file;                 // empty for a clear
+        juce::uint32 generation = 0;     // bumped by every request for the slot
+        juce::uint32 servedGeneration = 0;
+        juce::uint32 requestTime = 0;    // millisecond counter of the latest request
+    };
+
+    struct Completion
+    {
+        int slotIndex = 0;
+        juce::File file;
+        bool success = false;
+    };
+
+    //==============================================================================
+    IRManager& irManager;
+    ConvolutionEngine& convolutionEngine;
+
+    std::vector<SlotRequest> requests;      // guarded by requestLock
+    int servingSlot = -1;                   // guarded by requestLock
+    mutable juce::CriticalSection requestLock;
+
+    std::vector<Completion> completions;    // guarded by completionLock
+    juce::CriticalSection completionLock;
+
+    juce::ListenerList<Listener> listeners;
+
+    // Loads wait this long for the burst to end; clears are served straight away
+    static constexpr int kCoalesceMs = 40;
+    static constexpr int kStopTimeoutMs = 4000;
+    static constexpr int kIdlePollMs = 2;
+
+    //==============================================================================
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    void queueRequest(int slotIndex, const juce::File& irFile);
+    bool takeNextRequest(int& slotIndex, SlotRequest& request, int& msUntilNext);
+    bool isSuperseded(int slotIndex, juce::uint32 generation) const;
+    bool hasPendingWork() const;
+    void serveRequest(int slotIndex, const SlotRequest& request);
+    void postCompletion(int slotIndex, const juce::File& irFile, bool success);
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(IRLoader)
+};
@@ -1,4 +1,58 @@
 #include "IRManager.h"
+#include <unordered_set>
+
+//==============================================================================
+// One pool for every plugin instance, so a 60-track session doesn't start 60 sets of threads
+struct IRManager::ScanPool
+{
+    juce::ThreadPool pool{ juce::ThreadPoolOptions{}
+                               .withThreadName("KingsCab IR Scan")
+                               .withNumberOfThreads(juce::jlimit(1, kMaxScanThreads, juce::SystemStats::getNumCpus()))
+                               .withDesiredThreadPriority(juce::Thread::Priority::low) };
+};
+
+//==============================================================================
+// Catalogs the IR files of one directory and queues a job for each of its subdirectories,
+// so large folders spread across the pool.
+class IRManager::ScanJob : public juce::ThreadPoolJob
+{
+public:
+    ScanJob(IRManager& managerToReport, PendingFolder& folderToFill, const juce::File& directoryToScan, int folderDepth)
+        : juce::ThreadPoolJob("IR scan: " + directoryToScan.getFileName()),
+          owner(managerToReport), pending(folderToFill), directory(directoryToScan), depth(folderDepth)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        // Only built if a file here needs a full reader, then shared by the rest of the job
+        std::unique_ptr<juce::AudioFormatManager> formatManager;
+
+        IRCatalog::DirectoryRecord record;
+        const bool complete = owner.readDirectory(directory, formatManager, record,
+            [this](const juce::File& subdirectory)
+            {
+                if (depth < kMaxFolderDepth)
+                    owner.addScanJob(pending, subdirectory, depth + 1);
+            },
+            [this] { return shouldExit(); });
+
+        // A cancelled scan is thrown away as a whole, so partial results are never published
+        if (!complete || shouldExit())
+            return jobHasFinished;
+
+        owner.finishScanJob(pending, directory, std::move(record));
+        return jobHasFinished;
+    }
+
+    const IRManager& getOwner() const noexcept { return owner; }
+
+private:
+    IRManager& owner;
+    PendingFolder& pending;
+    const juce::File directory;
+    const int depth;
+};
 
 //==============================================================================
 IRManager::IRManager()
@@ -13,15 +67,23 @@ IRManager::IRManager()
 
 IRManager::~IRManager()
 {
+    cancelScan();
+    cancelPendingUpdate();
+
+    // Keeps whatever a cancelled scan or prefetch had already probed
+    catalog->saveIfChanged();
 }
 
 //==============================================================================
 void IRManager::setIRDirectory(const juce::File& directory)
 {
-    juce::ScopedLock lock(folderLock);
-    
-    irRootDirectory = directory;
-    if (irRootDirectory.exists() && irRootDirectory.isDirectory())
+    {
+        juce::ScopedLock lock(folderLock);
+        irRootDirectory = directory;
+    }
+
+    // Not under the lock: cancelling a running scan waits for jobs that need it
+    if (directory.exists() && directory.isDirectory())
     {
         scanForIRs();
     }
@@ -29,9 +91,14 @@ void IRManager::setIRDirectory(const juce::File& directory)
 
 void IRManager::scanForIRs()
 {
+    // Any scan still running belongs to the old tree
+    cancelScan();
+
     juce::ScopedLock lock(folderLock);
     
     folders.clear();
+    prefetchQueue.clear();
+    triggerAsyncUpdate();
     
     if (!irRootDirectory.exists() || !irRootDirectory.isDirectory())
     {
@@ -41,61 +108,213 @@ void IRManager::scanForIRs()
     
     DBG("IRManager: Scanning directory: " << irRootDirectory.getFullPathName());
 
-    // Scan all subdirectories for IR files
-    for (juce::DirectoryEntry entry : juce::RangedDirectoryIterator(irRootDirectory, false, "*", juce::File::findDirectories))
+    // Only the folder names are read here: a 60-track session would otherwise list and probe
+    // the whole library on load. Contents follow when requestFolder() or prefetchFolders() ask.
+    for (const juce::DirectoryEntry& entry : juce::RangedDirectoryIterator(irRootDirectory, false, "*", juce::File::findDirectories))
     {
         auto subDir = entry.getFile();
-        if (subDir.isDirectory())
-        {
-            DBG("IRManager: Found directory: " << subDir.getFileName());
-            FolderInfo folderInfo(subDir);
-            scanDirectory(subDir, folderInfo);
-            
-            DBG("IRManager: Directory '" << subDir.getFileName() << "' contains " << folderInfo.irFiles.size() << " IR files");
-            
-            // Add ALL folders, even if they appear empty (for debugging)
-            folders.push_back(std::move(folderInfo));
-            DBG("IRManager: Added folder: " << folderInfo.name << " (contains " << folderInfo.irFiles.size() << " IR files)");
-            
-            // Debug: Also add a note if the folder was empty
-            if (folderInfo.irFiles.empty())
-            {
-                DBG("IRManager: WARNING: Added empty folder: " << subDir.getFileName());
-            }
-        }
+        DBG("IRManager: Found directory: " << subDir.getFileName());
+        folders.emplace_back(subDir);
     }
 
-    // Don't scan root directory directly - only subdirectories
-
-    // Sort folders alphabetically
-    std::sort(folders.begin(), folders.end(), 
+    std::sort(folders.begin(), folders.end(),
         [](const FolderInfo& a, const FolderInfo& b) {
             return a.name.compareIgnoreCase(b.name) < 0;
         });
+
+    // Don't scan root directory directly - only subdirectories
+}
+
+void IRManager::prefetchFolders()
+{
+    juce::ScopedLock lock(folderLock);
+
+    prefetchQueue.clear();
+    for (const auto& folder : folders)
+    {
+        if (!folder.isPopulated)
+            prefetchQueue.push_back(folder.directory);
+    }
+
+    if (pendingFolders.empty())
+        startNextPrefetch();
+}
+
+bool IRManager::isScanning() const
+{
+    juce::ScopedLock lock(folderLock);
+    return !pendingFolders.empty();
+}
+
+void IRManager::cancelScan()
+{
+    struct OwnJobs : public juce::ThreadPool::JobSelector
+    {
+        explicit OwnJobs(const IRManager& managerToMatch) : manager(managerToMatch) {}
+
+        bool isJobSuitable(juce::ThreadPoolJob* job) override
+        {
+            auto* scanJob = dynamic_cast<ScanJob*>(job);
+            return scanJob != nullptr && &scanJob->getOwner() == &manager;
+        }
+
+        const IRManager& manager;
+    };
+
+    {
+        // Stops running jobs from queueing subdirectories behind the removal below
+        juce::ScopedLock lock(folderLock);
+        if (pendingFolders.empty())
+            return;
+
+        acceptingScanJobs = false;
+    }
+
+    // Jobs check shouldExit() between files, so this waits for one probe at most
+    OwnJobs ownJobs(*this);
+    scanPool->pool.removeAllJobs(true, -1, &ownJobs);
+
+    juce::ScopedLock lock(folderLock);
+    pendingFolders.clear();
+    acceptingScanJobs = true;
+}
+
+void IRManager::requestFolder(const juce::File& directory)
+{
+    juce::ScopedLock lock(folderLock);
+
+    auto folder = std::find_if(folders.begin(), folders.end(),
+        [&directory](const FolderInfo& candidate) { return candidate.directory == directory; });
+
+    if (folder == folders.end() || folder->isPopulated || !acceptingScanJobs)
+        return;
+
+    for (const auto& pending : pendingFolders)
+    {
+        if (pending->directory == directory)
+            return;
+    }
+
+    DBG("IRManager: Populating folder: " << folder->name);
+
+    pendingFolders.push_back(std::make_unique<PendingFolder>());
+    pendingFolders.back()->directory = directory;
+    addScanJob(*pendingFolders.back(), directory, 0);
+}
+
+void IRManager::startNextPrefetch()
+{
+    // One folder at a time, so a prefetch never holds up a folder someone is waiting for
+    // by more than the jobs already running
+    juce::ScopedLock lock(folderLock);
+
+    while (!prefetchQueue.empty() && pendingFolders.empty())
+    {
+        const auto directory = prefetchQueue.front();
+        prefetchQueue.erase(prefetchQueue.begin());
+        requestFolder(directory);
+    }
+}
+
+void IRManager::addScanJob(PendingFolder& pending, const juce::File& directory, int depth)
+{
+    // Held while queueing, so cancelScan() either sees this job or stops it being added
+    juce::ScopedLock lock(folderLock);
+
+    if (!acceptingScanJobs)
+        return;
+
+    ++pending.remainingJobs;
+    scanPool->pool.addJob(new ScanJob(*this, pending, directory, depth), true);
+}
+
+void IRManager::finishScanJob(PendingFolder& pending, const juce::File& directory, IRCatalog::DirectoryRecord&& record)
+{
+    // Taken under the lock, while this manager is certainly alive: once the last folder is
+    // gone its destructor no longer waits for this job, but the catalog must outlive the save
+    std::optional<juce::SharedResourcePointer<IRCatalog>> catalogToSave;
+
+    {
+        juce::ScopedLock lock(folderLock);
+
+        pending.scannedDirectories[directory.getFullPathName()] = std::move(record);
+
+        if (--pending.remainingJobs > 0)
+            return;
+
+        auto folder = std::find_if(folders.begin(), folders.end(),
+            [&pending](const FolderInfo& candidate) { return candidate.directory == pending.directory; });
+
+        if (folder != folders.end())
+        {
+            *folder = buildFolder(pending.directory, pending.scannedDirectories);
+            folder->isPopulated = true;
+
+            DBG("IRManager: Populated folder: " << folder->name << " (contains " << folder->irFiles.size()
+                << " IR files and " << folder->subfolders.size() << " subfolders)");
+        }
+
+        // This was the folder's last job, so nothing else refers to it
+        pendingFolders.erase(std::find_if(pendingFolders.begin(), pendingFolders.end(),
+            [&pending](const auto& candidate) { return candidate.get() == &pending; }));
+
+        // Still under the lock: once the last folder is gone the destructor no longer waits
+        triggerAsyncUpdate();
+
+        if (pendingFolders.empty())
+        {
+            startNextPrefetch();
+
+            // Nothing requested or prefetched is left, so the scan is complete
+            if (pendingFolders.empty())
+                catalogToSave.emplace(catalog);
+        }
+    }
+
+    // Written once per scan, and outside folderLock so folder queries never wait on the disk
+    if (catalogToSave.has_value())
+        (*catalogToSave)->saveIfChanged();
+}
+
+void IRManager::handleAsyncUpdate()
+{
+    listeners.call([](Listener& listener) { listener.irFoldersChanged(); });
 }
 
 //==============================================================================
-const IRManager::FolderInfo* IRManager::getFolder(int index) const
+std::vector<IRManager::FolderInfo> IRManager::getFolders() const
+{
+    juce::ScopedLock lock(folderLock);
+    return folders;
+}
+
+int IRManager::getNumFolders() const
+{
+    juce::ScopedLock lock(folderLock);
+    return static_cast<int>(folders.size());
+}
+
+std::optional<IRManager::FolderInfo> IRManager::getFolder(int index) const
 {
     juce::ScopedLock lock(folderLock);
     
     if (index >= 0 && index < static_cast<int>(folders.size()))
-        return &folders[index];
+        return folders[static_cast<size_t>(index)];
     
-    return nullptr;
+    return std::nullopt;
 }
 
-const IRManager::FolderInfo* IRManager::getFolderByName(const juce::String& name) const
+std::optional<IRManager::FolderInfo> IRManager::getFolderByName(const juce::String& name) const
 {
     juce::ScopedLock lock(folderLock);
     
     for (const auto& folder : folders)
     {
         if (folder.name.equalsIgnoreCase(name))
-            return &folder;
+            return folder;
     }
     
-    return nullptr;
+    return std::nullopt;
 }
 
 //==============================================================================
@@ -104,33 +323,48 @@ bool IRManager::loadIR(int slotIndex, const juce::File& irFile)
     if (slotIndex < 0 || slotIndex >= kMaxIRSlots)
         return false;
 
-    if (!isValidIRFile(irFile))
-        return false;
-
-    juce::ScopedLock lock(irLock);
-    
-    auto& slot = loadedIRs[slotIndex];
-    
     // Create new buffer for pristine audio quality
     auto newBuffer = std::make_unique<juce::AudioBuffer<float>>();
-    IRInfo newInfo = getIRInfo(irFile);
+    IRInfo newInfo;
     
-    if (loadIRBuffer(irFile, *newBuffer, newInfo))
+    if (readIR(irFile, *newBuffer, newInfo))
     {
-        // Process for optimal quality
-        validateAndProcessIR(*newBuffer, newInfo);
-        
-        // Atomically replace the old IR
-        slot.buffer = std::move(newBuffer);
-        slot.info = newInfo;
-        slot.isLoaded = true;
-        
+        storeIR(slotIndex, std::move(newBuffer), newInfo);
         return true;
     }
     
     return false;
 }
 
+bool IRManager::readIR(const juce::File& irFile, juce::AudioBuffer<float>& buffer, IRInfo& info)
+{
+    if (!isValidIRFile(irFile))
+        return false;
+
+    info = getIRInfo(irFile);
+
+    if (!loadIRBuffer(irFile, buffer, info))
+        return false;
+
+    // Process for optimal quality
+    validateAndProcessIR(buffer, info);
+    return true;
+}
+
+void IRManager::storeIR(int slotIndex, std::unique_ptr<juce::AudioBuffer<float>> buffer, const IRInfo& info)
+{
+    if (slotIndex < 0 || slotIndex >= kMaxIRSlots || buffer == nullptr)
+        return;
+
+    juce::ScopedLock lock(irLock);
+    
+    // Atomically replace the old IR
+    auto& slot = loadedIRs[slotIndex];
+    slot.buffer = std::move(buffer);
+    slot.info = info;
+    slot.isLoaded = true;
+}
+
 void IRManager::clearIR(int slotIndex)
 {
     if (slotIndex < 0 || slotIndex >= kMaxIRSlots)
@@ -153,39 +387,39 @@ bool IRManager::isIRLoaded(int slotIndex) const
     return loadedIRs[slotIndex].isLoaded;
 }
 
-const IRManager::IRInfo* IRManager::getLoadedIRInfo(int slotIndex) const
+std::optional<IRManager::IRInfo> IRManager::getLoadedIRInfo(int slotIndex) const
 {
     if (slotIndex < 0 || slotIndex >= kMaxIRSlots)
-        return nullptr;
+        return std::nullopt;
 
     juce::ScopedLock lock(irLock);
     
     const auto& slot = loadedIRs[slotIndex];
-    return slot.isLoaded ? &slot.info : nullptr;
+    return slot.isLoaded ? std::optional<IRInfo>(slot.info) : std::nullopt;
 }
 
-const juce::File& IRManager::getLoadedIR(int slotIndex) const
+juce::File IRManager::getLoadedIR(int slotIndex) const
 {
-    static juce::File emptyFile;
-    
     if (slotIndex < 0 || slotIndex >= kMaxIRSlots)
-        return emptyFile;
+        return {};
 
     juce::ScopedLock lock(irLock);
     
+    // Returned by value: the background loader may replace the slot at any time
     const auto& slot = loadedIRs[slotIndex];
-    return slot.isLoaded ? slot.info.file : emptyFile;
+    return slot.isLoaded ? slot.info.file : juce::File();
 }
 
-const juce::AudioBuffer<float>* IRManager::getIRBuffer(int slotIndex) const
+std::shared_ptr<const juce::AudioBuffer<float>> IRManager::getIRBuffer(int slotIndex) const
 {
     if (slotIndex < 0 || slotIndex >= kMaxIRSlots)
         return nullptr;
 
     juce::ScopedLock lock(irLock);
     
+    // The caller's reference keeps the buffer alive after a newer IR replaces it
     const auto& slot = loadedIRs[slotIndex];
-    return slot.isLoaded ? slot.buffer.get() : nullptr;
+    return slot.isLoaded ? slot.buffer : nullptr;
 }
 
 //==============================================================================
@@ -194,170 +428,266 @@ bool IRManager::isValidIRFile(const juce::File& file)
     if (!file.exists())
         return false;
     
-    // Support multiple audio formats common for IRs (case insensitive)
-    juce::StringArray validExtensions = { "wav", "aiff", "aif", "flac", "ogg", "m4a", "mp3" };
-    bool hasValidExtension = false;
-    auto fileExtension = file.getFileExtension().toLowerCase();
-    
-    for (const auto& ext : validExtensions)
-    {
-        if (fileExtension == ("." + ext))
-        {
-            hasValidExtension = true;
-            break;
-        }
-    }
-    
-    if (!hasValidExtension)
-        return false;
-
-    // Quick format check using JUCE's audio format manager
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-    
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-    
-    if (reader == nullptr)
+    if (!hasIRExtension(file))
         return false;
 
-    // Validate sample rate and length for IR processing
-    if (reader->sampleRate < kMinValidSampleRate || reader->sampleRate > kMaxValidSampleRate)
-        return false;
-
-    if (reader->lengthInSamples > kMaxIRLengthSamples || reader->lengthInSamples <= 0)
-        return false;
+    std::unique_ptr<juce::AudioFormatManager> formatManager;
+    return probeIRFile(file, formatManager).isValid;
+}
 
-    // Must be mono or stereo
-    if (reader->numChannels < 1 || reader->numChannels > 2)
-        return false;
+IRManager::IRInfo IRManager::getIRInfo(const juce::File& file)
+{
+    if (!file.exists())
+        return IRInfo(file);
 
-    return true;
+    std::unique_ptr<juce::AudioFormatManager> formatManager;
+    return probeIRFile(file, formatManager);
 }
 
-IRManager::IRInfo IRManager::getIRInfo(const juce::File& file)
+IRManager::IRInfo IRManager::probeIRFile(const juce::File& file, std::unique_ptr<juce::AudioFormatManager>& formatManager)
 {
     IRInfo info(file);
-    
-    if (!file.exists())
-        return info;
+    juce::int64 lengthInSamples = 0;
 
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-    
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-    
-    if (reader != nullptr)
+    if (auto header = IRFileHeader::read(file))
     {
+        info.sampleRate = header->sampleRate;
+        info.numChannels = header->numChannels;
+        lengthInSamples = header->lengthInSamples;
+    }
+    else
+    {
+        // Compressed or unusual encodings: only these pay for a format manager and a reader
+        if (formatManager == nullptr)
+        {
+            formatManager = std::make_unique<juce::AudioFormatManager>();
+            formatManager->registerBasicFormats();
+        }
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager->createReaderFor(file));
+        
+        if (reader == nullptr)
+            return info;
+
         info.sampleRate = reader->sampleRate;
-        info.lengthInSamples = static_cast<int>(reader->lengthInSamples);
         info.numChannels = static_cast<int>(reader->numChannels);
-        info.isValid = isValidIRFile(file);
+        lengthInSamples = reader->lengthInSamples;
     }
+
+    info.lengthInSamples = static_cast<int>(juce::jmin(lengthInSamples, static_cast<juce::int64>(std::numeric_limits<int>::max())));
+
+    // Validate sample rate and length for IR processing; must be mono or stereo
+    info.isValid = info.sampleRate >= kMinValidSampleRate && info.sampleRate <= kMaxValidSampleRate
+                && info.lengthInSamples > 0 && lengthInSamples <= kMaxIRLengthSamples
+                && info.numChannels >= 1 && info.numChannels <= 2;
     
     return info;
 }
 
 //==============================================================================
-void IRManager::scanDirectory(const juce::File& directory, FolderInfo& folderInfo)
+bool IRManager::readDirectory(const juce::File& directory, std::unique_ptr<juce::AudioFormatManager>& formatManager,
+                              IRCatalog::DirectoryRecord& record,
+                              const std::function<void(const juce::File&)>& foundSubdirectory,
+                              const std::function<bool()>& shouldStop)
 {
-    DBG("IRManager: Scanning directory contents: " << directory.getFullPathName());
-    
-    // Scan for multiple audio file formats common for IRs
-    juce::StringArray audioExtensions = { "*.wav", "*.aiff", "*.aif", "*.flac", "*.ogg", "*.m4a", "*.mp3", "*.WAV", "*.AIFF", "*.AIF", "*.FLAC", "*.OGG", "*.M4A", "*.MP3" };
-    
-    int totalFilesFound = 0;
-    int validFilesFound = 0;
-    
-    // First, scan for files directly in this directory
-    for (const auto& extension : audioExtensions)
+    // Taken before listing, so anything that changes during the scan is caught next time
+    const auto modificationTime = directory.getLastModificationTime().toMilliseconds();
+
+    IRCatalog::DirectoryRecord previous;
+    int filesProbed = 0;
+
+    if (catalog->findDirectory(directory, previous) && previous.modificationTime == modificationTime)
     {
-        for (juce::DirectoryEntry entry : juce::RangedDirectoryIterator(directory, false, extension, juce::File::findFiles))
+        // The listing is unchanged, but a file rewritten in place doesn't touch its directory's
+        // mtime, so every file is still stat'ed and probed again if its size or mtime differ
+        bool listingChanged = false;
+
+        for (auto& fileRecord : previous.files)
         {
-            auto file = entry.getFile();
-            totalFilesFound++;
-            DBG("IRManager: Found file: " << file.getFileName() << " (extension: " << extension << ")");
-            
-            if (isValidIRFile(file))
+            if (shouldStop())
+                return false;
+
+            const auto file = directory.getChildFile(fileRecord.fileName);
+
+            // Removed within the directory mtime's granularity: fall back to a full listing
+            if (!file.existsAsFile())
             {
-                IRInfo irInfo = getIRInfo(file);
-                if (irInfo.isValid)
-                {
-                    folderInfo.irFiles.push_back(std::move(irInfo));
-                    validFilesFound++;
-                    DBG("IRManager: Added valid IR: " << file.getFileName());
-                }
-                else
-                {
-                    DBG("IRManager: IR info invalid for: " << file.getFileName());
-                }
+                listingChanged = true;
+                break;
             }
-            else
+
+            const auto size = file.getSize();
+            const auto fileModificationTime = file.getLastModificationTime().toMilliseconds();
+
+            if (size == fileRecord.size && fileModificationTime == fileRecord.modificationTime)
+                continue;
+
+            fileRecord.size = size;
+            fileRecord.modificationTime = fileModificationTime;
+            probeIntoRecord(file, formatManager, fileRecord);
+            ++filesProbed;
+        }
+
+        if (!listingChanged)
+        {
+            record = std::move(previous);
+
+            for (const auto& subdirectory : record.subdirectories)
+                foundSubdirectory(directory.getChildFile(subdirectory));
+
+            if (filesProbed > 0)
             {
-                DBG("IRManager: File not valid IR: " << file.getFileName());
+                DBG("IRManager: Re-probed " << filesProbed << " changed files in " << directory.getFileName());
+                catalog->storeDirectory(directory, record);
             }
+
+            return true;
         }
     }
-    
-    // Then, recursively scan subdirectories for files
-    for (juce::DirectoryEntry entry : juce::RangedDirectoryIterator(directory, false, "*", juce::File::findDirectories))
+
+    DBG("IRManager: Scanning directory contents: " << directory.getFullPathName());
+
+    record = {};
+    record.modificationTime = modificationTime;
+    filesProbed = 0;
+
+    // One listing for subdirectories and files alike; extensions are matched here rather
+    // than by wildcard, which also means no duplicates on case-insensitive filesystems
+    for (const juce::DirectoryEntry& entry : juce::RangedDirectoryIterator(directory, false, "*", juce::File::findFilesAndDirectories))
     {
-        auto subDir = entry.getFile();
-        DBG("IRManager: Found subdirectory: " << subDir.getFileName());
-        
-        // Recursively scan this subdirectory for IR files
-        for (const auto& extension : audioExtensions)
+        if (shouldStop())
+            return false;
+
+        const auto file = entry.getFile();
+
+        if (entry.isDirectory())
         {
-            for (juce::DirectoryEntry subEntry : juce::RangedDirectoryIterator(subDir, false, extension, juce::File::findFiles))
-            {
-                auto file = subEntry.getFile();
-                totalFilesFound++;
-                
-                // Create a display name that includes the subdirectory name
-                auto displayName = subDir.getFileName() + "/" + file.getFileNameWithoutExtension();
-                
-                DBG("IRManager: Found nested file: " << displayName << " (" << file.getFileExtension() << ")");
-                
-                if (isValidIRFile(file))
-                {
-                    IRInfo irInfo = getIRInfo(file);
-                    if (irInfo.isValid)
-                    {
-                        irInfo.name = displayName; // Override name to include subdirectory
-                        folderInfo.irFiles.push_back(std::move(irInfo));
-                        validFilesFound++;
-                        DBG("IRManager: Added valid nested IR: " << displayName);
-                    }
-                    else
-                    {
-                        DBG("IRManager: Nested IR info invalid for: " << displayName);
-                    }
-                }
-                else
-                {
-                    DBG("IRManager: Nested file not valid IR: " << displayName);
-                }
-            }
+            record.subdirectories.add(file.getFileName());
+            foundSubdirectory(file);
+            continue;
+        }
+
+        if (!hasIRExtension(file))
+            continue;
+
+        IRCatalog::FileRecord fileRecord;
+        fileRecord.fileName = file.getFileName();
+        fileRecord.size = entry.getFileSize();
+        fileRecord.modificationTime = entry.getModificationTime().toMilliseconds();
+
+        // Files whose size and mtime haven't changed keep what the catalog knows about them
+        auto cached = std::find_if(previous.files.begin(), previous.files.end(),
+            [&fileRecord](const IRCatalog::FileRecord& candidate) {
+                return candidate.fileName == fileRecord.fileName
+                    && candidate.size == fileRecord.size
+                    && candidate.modificationTime == fileRecord.modificationTime;
+            });
+
+        if (cached != previous.files.end())
+        {
+            fileRecord = *cached;
         }
+        else
+        {
+            probeIntoRecord(file, formatManager, fileRecord);
+            ++filesProbed;
+        }
+
+        record.files.push_back(std::move(fileRecord));
     }
     
-    DBG("IRManager: Directory scan complete. Found " << totalFilesFound << " total files, " << validFilesFound << " valid IRs");
-    
-    // Sort IR files by name for consistent ordering, then deduplicate by name and file path
-    std::sort(folderInfo.irFiles.begin(), folderInfo.irFiles.end(),
+    DBG("IRManager: Directory scan complete for " << directory.getFileName() << ". Found "
+        << static_cast<int>(record.files.size()) << " total files, probed " << filesProbed);
+
+    catalog->storeDirectory(directory, record);
+    return true;
+}
+
+void IRManager::probeIntoRecord(const juce::File& file, std::unique_ptr<juce::AudioFormatManager>& formatManager,
+                                IRCatalog::FileRecord& fileRecord)
+{
+    // Usually a few KB of header; only unusual encodings open a full reader
+    const auto irInfo = probeIRFile(file, formatManager);
+    fileRecord.sampleRate = irInfo.sampleRate;
+    fileRecord.lengthInSamples = irInfo.lengthInSamples;
+    fileRecord.numChannels = irInfo.numChannels;
+    fileRecord.isValid = irInfo.isValid;
+
+    if (!irInfo.isValid)
+        DBG("IRManager: File not valid IR: " << file.getFullPathName());
+}
+
+bool IRManager::hasIRExtension(const juce::File& file)
+{
+    // Audio formats common for IRs, matched case-insensitively
+    static const std::unordered_set<juce::String> extensions { ".wav", ".aiff", ".aif", ".flac", ".ogg", ".m4a", ".mp3" };
+    return extensions.count(file.getFileExtension().toLowerCase()) > 0;
+}
+
+IRManager::FolderInfo IRManager::buildFolder(const juce::File& directory,
+                                             const std::map<juce::String, IRCatalog::DirectoryRecord>& scannedDirectories)
+{
+    FolderInfo folder(directory);
+
+    // Directories below the depth limit were never scanned
+    auto scanned = scannedDirectories.find(directory.getFullPathName());
+    if (scanned == scannedDirectories.end())
+        return folder;
+
+    const auto& record = scanned->second;
+
+    for (const auto& fileRecord : record.files)
+    {
+        if (fileRecord.isValid)
+            folder.irFiles.push_back(makeIRInfo(directory, fileRecord));
+    }
+
+    sortAndDeduplicate(folder.irFiles);
+
+    for (const auto& subdirectory : record.subdirectories)
+    {
+        auto subfolder = buildFolder(directory.getChildFile(subdirectory), scannedDirectories);
+
+        if (!subfolder.isEmpty())
+            folder.subfolders.push_back(std::move(subfolder));
+    }
+
+    std::sort(folder.subfolders.begin(), folder.subfolders.end(),
+        [](const FolderInfo& a, const FolderInfo& b) {
+            return a.name.compareIgnoreCase(b.name) < 0;
+        });
+
+    return folder;
+}
+
+IRManager::IRInfo IRManager::makeIRInfo(const juce::File& directory, const IRCatalog::FileRecord& fileRecord)
+{
+    IRInfo info(directory.getChildFile(fileRecord.fileName));
+    info.sampleRate = fileRecord.sampleRate;
+    info.lengthInSamples = fileRecord.lengthInSamples;
+    info.numChannels = fileRecord.numChannels;
+    info.isValid = fileRecord.isValid;
+    return info;
+}
+
+void IRManager::sortAndDeduplicate(std::vector<IRInfo>& irFiles)
+{
+    // Sort IR files by name for consistent ordering; of files that differ only by extension
+    // (e.g. a .wav and an .aiff export of the same IR) the first by path is kept
+    std::sort(irFiles.begin(), irFiles.end(),
         [](const IRInfo& a, const IRInfo& b) {
             const int nameCmp = a.name.compareIgnoreCase(b.name);
             if (nameCmp != 0) return nameCmp < 0;
             return a.file.getFullPathName().compareIgnoreCase(b.file.getFullPathName()) < 0;
         });
 
-    folderInfo.irFiles.erase(
-        std::unique(folderInfo.irFiles.begin(), folderInfo.irFiles.end(),
+    irFiles.erase(
+        std::unique(irFiles.begin(), irFiles.end(),
             [](const IRInfo& x, const IRInfo& y){
-                return x.name.equalsIgnoreCase(y.name) ||
-                       x.file.getFullPathName().equalsIgnoreCase(y.file.getFullPathName());
+                return x.name.equalsIgnoreCase(y.name);
             }
         ),
-        folderInfo.irFiles.end()
+        irFiles.end()
     );
 }
 
@@ -431,7 +761,8 @@ void IRManager::validateAndProcessIR(juce::AudioBuffer<float>& buffer, IRInfo& i
         info.lengthInSamples = actualLength;
     }
     
-    // Apply gentle fade-out to prevent clicks (last 64 samples)
+    // Apply gentle fade-out to prevent clicks (last 64 samples of the trimmed IR)
+    numSamples = buffer.getNumSamples();
     const int fadeLength = juce::jmin(64, numSamples / 10);
     if (fadeLength > 0)
     {
@@ -447,13 +778,7 @@ void IRManager::validateAndProcessIR(juce::AudioBuffer<float>& buffer, IRInfo& i
         }
     }
     
-    // Convert mono to stereo if needed for consistent processing
-    if (numChannels == 1)
-    {
-        juce::AudioBuffer<float> stereoBuffer(2, buffer.getNumSamples());
-        stereoBuffer.copyFrom(0, 0, buffer, 0, 0, buffer.getNumSamples());
-        stereoBuffer.copyFrom(1, 0, buffer, 0, 0, buffer.getNumSamples());
-        buffer = std::move(stereoBuffer);
-        info.numChannels = 2;
-    }
+    // Mono IRs stay mono: the convolution engine applies one IR channel to every
+    // output channel instead of convolving a duplicated copy
+    info.numChannels = numChannels;
 }
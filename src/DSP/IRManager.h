@@ -3,6 +3,12 @@
 #include <JuceHeader.h>
 #include <vector>
 #include <array>
+#include <map>
+#include <memory>
+#include <optional>
+#include <functional>
+#include "IRCatalog.h"
+#include "IRFileHeader.h"
 
 //==============================================================================
 /**
@@ -10,14 +16,29 @@
  * 
  * Handles:
  * - IR file loading and validation
- * - Folder structure management
+ * - Folder structure management: each top-level folder is a tree of its subfolders, to
+ *   any depth (mic positions, rooms, ...)
  * - IR metadata and organization
  * - Thread-safe access to IR data
+ * - Lazy library scans: only the top-level folder names are listed up front, and a folder
+ *   is listed and probed (on a thread pool shared by all plugin instances) the first time
+ *   it is requested, or later by an idle-time prefetch
+ * - A persistent catalog of probed files, so unchanged directories aren't listed again on
+ *   the next instantiation, and only files whose size or mtime changed are probed again
  */
-class IRManager
+class IRManager : private juce::AsyncUpdater
 {
 public:
     //==============================================================================
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        // Called on the message thread when the folder list is read or folders are populated
+        virtual void irFoldersChanged() = 0;
+    };
+
     struct IRInfo
     {
         juce::File file;
@@ -41,46 +62,73 @@ public:
         juce::String name;
         juce::File directory;
         std::vector<IRInfo> irFiles;
+        std::vector<FolderInfo> subfolders; // sorted by name; only those with IRs somewhere below
+        bool isPopulated = false;           // top-level folders: irFiles and subfolders are filled in
 
         FolderInfo() = default;
         FolderInfo(const juce::File& dir) : directory(dir)
         {
             name = dir.getFileName();
         }
+
+        bool isEmpty() const { return irFiles.empty() && subfolders.empty(); }
     };
 
     //==============================================================================
     IRManager();
-    ~IRManager();
+    ~IRManager() override;
 
     //==============================================================================
-    // Directory Management
+    // Directory Management. Setting or rescanning the directory only lists its top-level
+    // folders; their contents are read in the background once asked for.
     void setIRDirectory(const juce::File& directory);
     const juce::File& getIRDirectory() const { return irRootDirectory; }
     void scanForIRs();
+    bool isScanning() const;
+
+    // Starts populating a top-level folder unless it already is (or is on its way)
+    void requestFolder(const juce::File& directory);
+
+    // Populates the remaining folders one at a time, only while nothing else is being scanned
+    void prefetchFolders();
 
     //==============================================================================
-    // Folder Access
-    const std::vector<FolderInfo>& getFolders() const { return folders; }
-    int getNumFolders() const { return static_cast<int>(folders.size()); }
-    const FolderInfo* getFolder(int index) const;
-    const FolderInfo* getFolderByName(const juce::String& name) const;
+    // Folder Access (copies: scan workers keep publishing while the UI reads)
+    std::vector<FolderInfo> getFolders() const;
+    int getNumFolders() const;
+    std::optional<FolderInfo> getFolder(int index) const;
+    std::optional<FolderInfo> getFolderByName(const juce::String& name) const;
+
+    void addListener(Listener* listener) { listeners.add(listener); }
+    void removeListener(Listener* listener) { listeners.remove(listener); }
 
     //==============================================================================
     // IR Loading and Management
     bool loadIR(int slotIndex, const juce::File& irFile);
     void clearIR(int slotIndex);
+
+    // Two halves of loadIR(): decoding touches no slot state (safe on any thread, so
+    // the background loader can drop a superseded result), storing commits it
+    bool readIR(const juce::File& irFile, juce::AudioBuffer<float>& buffer, IRInfo& info);
+    void storeIR(int slotIndex, std::unique_ptr<juce::AudioBuffer<float>> buffer, const IRInfo& info);
     bool isIRLoaded(int slotIndex) const;
 
-    const IRInfo* getLoadedIRInfo(int slotIndex) const;
-    const juce::File& getLoadedIR(int slotIndex) const;
-    const juce::AudioBuffer<float>* getIRBuffer(int slotIndex) const;
+    // Taken under the slot lock: the background loader may replace a slot at any time, so
+    // callers get a copy of the info and their own reference to the buffer
+    std::optional<IRInfo> getLoadedIRInfo(int slotIndex) const;
+    juce::File getLoadedIR(int slotIndex) const;
+    std::shared_ptr<const juce::AudioBuffer<float>> getIRBuffer(int slotIndex) const;
 
     //==============================================================================
     // IR Validation
     static bool isValidIRFile(const juce::File& file);
     static IRInfo getIRInfo(const juce::File& file);
 
+    // Everything the catalog needs to know about a file, usually from its header alone. The
+    // format manager is only created (and then kept for the caller's next files) when a
+    // file needs a full reader.
+    static IRInfo probeIRFile(const juce::File& file, std::unique_ptr<juce::AudioFormatManager>& formatManager);
+
     //==============================================================================
     // Constants
     static constexpr int kMaxIRSlots = 6;
@@ -93,23 +141,58 @@ private:
     struct LoadedIR
     {
         IRInfo info;
-        std::unique_ptr<juce::AudioBuffer<float>> buffer;
+        std::shared_ptr<const juce::AudioBuffer<float>> buffer;
         bool isLoaded = false;
     };
 
+    // A top-level folder whose directory jobs haven't all finished yet
+    struct PendingFolder
+    {
+        juce::File directory;
+        std::map<juce::String, IRCatalog::DirectoryRecord> scannedDirectories; // keyed by full path
+        int remainingJobs = 0;
+    };
+
+    class ScanJob;
+    struct ScanPool;
+
     //==============================================================================
     // Core data
     juce::File irRootDirectory;
-    std::vector<FolderInfo> folders;
+    std::vector<FolderInfo> folders;                            // published, sorted by name
+    std::vector<std::unique_ptr<PendingFolder>> pendingFolders; // guarded by folderLock
+    std::vector<juce::File> prefetchQueue;                      // guarded by folderLock
+    bool acceptingScanJobs = true;                              // guarded by folderLock
     std::array<LoadedIR, kMaxIRSlots> loadedIRs;
 
     // Thread safety
     mutable juce::CriticalSection folderLock;
     mutable juce::CriticalSection irLock;
 
+    juce::SharedResourcePointer<ScanPool> scanPool;
+    juce::SharedResourcePointer<IRCatalog> catalog;
+    juce::ListenerList<Listener> listeners;
+
+    static constexpr int kMaxScanThreads = 8;
+    static constexpr int kMaxFolderDepth = 16; // below a top-level folder; stops symlink loops
+
     //==============================================================================
     // Helper methods
-    void scanDirectory(const juce::File& directory, FolderInfo& folderInfo);
+    void cancelScan();
+    void startNextPrefetch();
+    void addScanJob(PendingFolder& pending, const juce::File& directory, int depth);
+    void finishScanJob(PendingFolder& pending, const juce::File& directory, IRCatalog::DirectoryRecord&& record);
+    void handleAsyncUpdate() override;
+    bool readDirectory(const juce::File& directory, std::unique_ptr<juce::AudioFormatManager>& formatManager,
+                       IRCatalog::DirectoryRecord& record,
+                       const std::function<void(const juce::File&)>& foundSubdirectory,
+                       const std::function<bool()>& shouldStop);
+    static void probeIntoRecord(const juce::File& file, std::unique_ptr<juce::AudioFormatManager>& formatManager,
+                                IRCatalog::FileRecord& fileRecord);
+    static bool hasIRExtension(const juce::File& file);
+    static FolderInfo buildFolder(const juce::File& directory, const std::map<juce::String, IRCatalog::DirectoryRecord>& scannedDirectories);
+    static IRInfo makeIRInfo(const juce::File& directory, const IRCatalog::FileRecord& fileRecord);
+    static void sortAndDeduplicate(std::vector<IRInfo>& irFiles);
     bool loadIRBuffer(const juce::File& file, juce::AudioBuffer<float>& buffer, IRInfo& info);
     void validateAndProcessIR(juce::AudioBuffer<float>& buffer, IRInfo& info);
 
@@ -0,0 +1,1342 @@
+#include "PartitionedConvolver.h"
+#include <thread>
+
+//==============================================================================
+const float* PartitionedConvolver::StageSpectra::getPartition(int channel, int partition) const noexcept
+{
+    return spectra.data() + static_cast<size_t>((channel * numPartitions + partition) * spectrumSize);
+}
+
+float* PartitionedConvolver::StageSpectra::getPartition(int channel, int partition) noexcept
+{
+    return const_cast<float*>(static_cast<const StageSpectra&>(*this).getPartition(channel, partition));
+}
+
+//==============================================================================
+PartitionedConvolver::PartitionedConvolver()
+{
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+}
+
+//==============================================================================
+bool PartitionedConvolver::prepare(int maximumBlockSize, int numChannelsToUse, int maxIRLength,
+                                   int numKernels, Layout layoutToUse)
+{
+    // Uniform partitions follow the host block size (like juce::dsp::Convolution), within sane FFT
+    // limits; the non-uniform layout is independent of it, so it can be allocated up front
+    const auto newPartitionSize = layoutToUse == Layout::uniform
+                                      ? juce::jlimit(64, 4096, juce::nextPowerOfTwo(juce::jmax(1, maximumBlockSize)))
+                                      : kHeadLength;
+    const auto newNumChannels = juce::jmax(1, numChannelsToUse);
+    const auto newIRLength = juce::jmax(1, maxIRLength);
+
+    // Nothing below is safe while the worker is reading the stages
+    stopBackgroundThread();
+
+    if (isPrepared() && layoutToUse == layout && newPartitionSize == partitionSize
+        && newNumChannels == numChannels && newIRLength == preparedIRLength
+        && numKernels == static_cast<int>(kernels.size()))
+    {
+        // Same buffers, but a new block size can move the direct-FIR / FFT trade-off
+        const bool blockSizeChanged = (maximumBlockSize != calibratedBlockSize);
+        if (blockSizeChanged)
+            calibratePathCosts(maximumBlockSize);
+
+        configureBackgroundStages();
+        reset();
+        startBackgroundThreadIfNeeded();
+        return blockSizeChanged;
+    }
+
+    layout = layoutToUse;
+    partitionSize = newPartitionSize;
+    numChannels = newNumChannels;
+    preparedIRLength = newIRLength;
+    headLength = (layout == Layout::nonUniform) ? kHeadLength : 0;
+
+    buildStages(preparedIRLength);
+
+    // Direct-form kernels can be used with either layout, so the FIR is always sized for them
+    headTaps.assign(static_cast<size_t>(numChannels * kMaxDirectFIRLength), 0.0f);
+    headHistory.assign(static_cast<size_t>(numChannels * (kMaxDirectFIRLength - 1 + kHeadHistoryBlock)), 0.0f);
+
+    int maxSpectrumSize = 0;
+    for (const auto& stage : stages)
+        maxSpectrumSize = juce::jmax(maxSpectrumSize, stage.spectrumSize);
+
+    const auto tailSpectrumSize = (!stages.empty() && stages.front().immediate) ? stages.front().spectrumSize : 0;
+
+    kernels.assign(static_cast<size_t>(numKernels), nullptr);
+    for (auto& stage : stages)
+        stage.work.weights.assign(static_cast<size_t>(numKernels), 0.0f);
+
+    kernelTails.assign(static_cast<size_t>(numKernels * numChannels * tailSpectrumSize), 0.0f);
+    kernelTailStamps.assign(static_cast<size_t>(numKernels * numChannels), 0);
+    accumulator.assign(static_cast<size_t>(maxSpectrumSize), 0.0f);
+    slotScratch.assign(static_cast<size_t>(maxSpectrumSize), 0.0f);
+
+    calibratePathCosts(maximumBlockSize);
+    configureBackgroundStages();
+    reset();
+    startBackgroundThreadIfNeeded();
+    return true;
+}
+
+void PartitionedConvolver::calibratePathCosts(int maximumBlockSize)
+{
+    // Rough timings on this machine, used by createKernel() to pick each kernel's path
+    calibratedBlockSize = maximumBlockSize;
+
+    const auto chunk = juce::jlimit(1, kHeadChunk, maximumBlockSize);
+    std::vector<float> source(static_cast<size_t>(kHeadChunk * 2), 0.0f);
+    std::vector<float> destination(static_cast<size_t>(kHeadChunk), 0.0f);
+
+    for (size_t i = 0; i < source.size(); ++i)
+        source[i] = std::sin(static_cast<float>(i) * 0.1f) * 0.5f;
+
+    // The FIR runs one vector multiply-add per tap over the host block
+    const auto firRepetitions = juce::jmax(256, 262144 / chunk);
+    auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (int i = 0; i < firRepetitions; ++i)
+        juce::FloatVectorOperations::addWithMultiply(destination.data(), source.data() + (i & (kHeadChunk - 1)),
+                                                     0.5f, chunk);
+
+    directCostPerTap = (juce::Time::getMillisecondCounterHiRes() - start) / (firRepetitions * static_cast<double>(chunk));
+
+    for (auto& stage : stages)
+    {
+        std::vector<float> block(static_cast<size_t>(stage.fftSize), 0.0f);
+        std::vector<float> scratch(static_cast<size_t>(stage.fftSize * 2), 0.0f);
+        std::vector<float> spectrum(static_cast<size_t>(stage.spectrumSize), 0.0f);
+        std::vector<float> sum(static_cast<size_t>(stage.spectrumSize), 0.0f);
+
+        for (int i = 0; i < stage.partitionSize; ++i)
+            block[static_cast<size_t>(i)] = source[static_cast<size_t>(i % kHeadChunk)];
+
+        const auto repetitions = juce::jmax(4, 65536 / stage.fftSize);
+
+        start = juce::Time::getMillisecondCounterHiRes();
+        for (int i = 0; i < repetitions; ++i)
+        {
+            forwardTransform(stage, *stage.fft, block.data(), spectrum.data(), scratch.data());
+            inverseTransform(stage, *stage.fft, spectrum.data(), scratch.data());
+        }
+        stage.transformCost = (juce::Time::getMillisecondCounterHiRes() - start) / repetitions;
+
+        start = juce::Time::getMillisecondCounterHiRes();
+        for (int i = 0; i < repetitions; ++i)
+            multiplyAccumulate(stage.numBins, spectrum.data(), spectrum.data(), sum.data());
+        stage.multiplyCost = (juce::Time::getMillisecondCounterHiRes() - start) / repetitions;
+    }
+}
+
+double PartitionedConvolver::estimateFFTCost(int irLength) const noexcept
+{
+    // Per-sample cost of running an IR of this length on its own through the partitions
+    auto cost = headLength * directCostPerTap;
+
+    for (const auto& stage : stages)
+    {
+        const auto stageSamples = irLength - stage.offset;
+        if (stageSamples <= 0)
+            break;
+
+        const auto numPartitions = juce::jmin(stage.maxPartitions, (stageSamples + stage.partitionSize - 1) / stage.partitionSize);
+
+        if (stage.immediate)
+        {
+            // Immediate stages transform and multiply the first partition on every call
+            const auto callSize = juce::jlimit(1, stage.partitionSize, calibratedBlockSize);
+            cost += (stage.transformCost + stage.multiplyCost) / callSize
+                  + (numPartitions - 1) * stage.multiplyCost / stage.partitionSize;
+        }
+        else
+        {
+            cost += (stage.transformCost + numPartitions * stage.multiplyCost) / stage.partitionSize;
+        }
+    }
+
+    return cost;
+}
+
+bool PartitionedConvolver::shouldUseDirectFIR(int irLength) const noexcept
+{
+    return irLength <= kMaxDirectFIRLength && irLength * directCostPerTap < estimateFFTCost(irLength);
+}
+
+void PartitionedConvolver::configureBackgroundStages()
+{
+    for (auto& stage : stages)
+    {
+        stage.background.reset();
+
+        // Only stages with a full partition of slack can wait for another thread
+        if (!useBackgroundThread || stage.immediate || stage.workBudget < stage.partitionSize
+            || stage.partitionSize < kMinBackgroundPartition)
+            continue;
+
+        stage.background = std::make_unique<BackgroundState>();
+
+        // The worker transforms concurrently with the audio thread, so it gets its own FFT
+        stage.background->fft = std::make_unique<juce::dsp::FFT>(getFFTOrder(stage.fftSize));
+
+        for (auto& job : stage.background->jobs)
+        {
+            job.input.assign(static_cast<size_t>(numChannels * stage.partitionSize), 0.0f);
+            job.output.assign(static_cast<size_t>(numChannels * stage.fftSize), 0.0f);
+            job.weights.assign(kernels.size(), 0.0f);
+            job.kernels.assign(kernels.size(), nullptr);
+        }
+    }
+}
+
+void PartitionedConvolver::startBackgroundThreadIfNeeded()
+{
+    for (const auto& stage : stages)
+    {
+        if (stage.background != nullptr)
+        {
+            backgroundWorker.startThread(juce::Thread::Priority::high);
+            return;
+        }
+    }
+}
+
+void PartitionedConvolver::stopBackgroundThread()
+{
+    backgroundWorker.stopThread(1000);
+}
+
+void PartitionedConvolver::buildStages(int maxIRLength)
+{
+    stages.clear();
+
+    auto addStage = [this](int size, int offset, int numPartitions, bool immediate)
+    {
+        auto& stage = stages.emplace_back();
+        stage.partitionSize = size;
+        stage.fftSize = size * 2;
+        stage.numBins = size + 1;
+        stage.spectrumSize = stage.numBins * 2;
+        stage.offset = offset;
+        stage.maxPartitions = juce::jmax(1, numPartitions);
+        stage.immediate = immediate;
+
+        // Output lands up to offset + size samples ahead of the block that produced it
+        stage.ringSize = immediate ? 0 : juce::nextPowerOfTwo(offset + size);
+
+        stage.fft = std::make_unique<juce::dsp::FFT>(getFFTOrder(stage.fftSize));
+
+        stage.channels.resize(static_cast<size_t>(numChannels));
+        for (auto& state : stage.channels)
+        {
+            state.inputBlock.assign(static_cast<size_t>(stage.fftSize), 0.0f);
+            state.history.assign(static_cast<size_t>(stage.maxPartitions * stage.spectrumSize), 0.0f);
+            state.fftBuffer.assign(static_cast<size_t>(stage.fftSize * 2), 0.0f);
+            state.overlap.assign(immediate ? static_cast<size_t>(size) : 0, 0.0f);
+            state.outputRing.assign(static_cast<size_t>(stage.ringSize), 0.0f);
+            state.pendingBlock.assign(immediate ? 0 : static_cast<size_t>(stage.fftSize), 0.0f);
+            state.workAccumulator.assign(immediate ? 0 : static_cast<size_t>(stage.spectrumSize), 0.0f);
+            state.workScratch.assign(immediate ? 0 : static_cast<size_t>(stage.spectrumSize), 0.0f);
+        }
+
+        // A block's output is due offset - size samples after it completes, and the
+        // next block completes after size samples, so the work gets whichever is shorter
+        stage.workBudget = immediate ? 0 : juce::jmin(size, offset - size);
+    };
+
+    if (layout == Layout::uniform)
+    {
+        addStage(partitionSize, 0, (maxIRLength + partitionSize - 1) / partitionSize, true);
+        return;
+    }
+
+    // Each size starts once the IR offset leaves a full partition of slack for it
+    // (offset >= 2 * size), e.g. 64 x3, 128 x2, 256 x2 ... 4096 x2, then 8192 to the end
+    int offset = headLength;
+    int size = headLength;
+
+    while (offset < maxIRLength)
+    {
+        auto numPartitions = (maxIRLength - offset + size - 1) / size;
+
+        if (size < kMaxNonUniformPartition)
+            numPartitions = juce::jmin(numPartitions, juce::jmax(1, (size * 4 - offset + size - 1) / size));
+
+        addStage(size, offset, numPartitions, false);
+
+        offset += numPartitions * size;
+        size = juce::jmin(size * 2, kMaxNonUniformPartition);
+    }
+}
+
+void PartitionedConvolver::reset()
+{
+    for (auto& stage : stages)
+    {
+        // A background stage's history belongs to the worker, which clears it before its next job
+        const bool inBackground = stage.background != nullptr;
+
+        for (auto& state : stage.channels)
+        {
+            std::fill(state.inputBlock.begin(), state.inputBlock.end(), 0.0f);
+            std::fill(state.overlap.begin(), state.overlap.end(), 0.0f);
+            std::fill(state.outputRing.begin(), state.outputRing.end(), 0.0f);
+
+            if (!inBackground)
+            {
+                std::fill(state.history.begin(), state.history.end(), 0.0f);
+                std::fill(state.pendingBlock.begin(), state.pendingBlock.end(), 0.0f);
+            }
+        }
+
+        if (inBackground)
+        {
+            cancelBackgroundJobs(stage);
+            stage.background->resetPending.store(true);
+        }
+
+        stage.work.pending = false;
+        stage.inputPosition = 0;
+        stage.currentSegment = 0;
+        stage.ringPosition = 0;
+    }
+
+    std::fill(headHistory.begin(), headHistory.end(), 0.0f);
+    headWritePosition = kMaxDirectFIRLength - 1;
+    activeChannels = numChannels;
+
+    // Stamps are compared against blockCounter, so moving it on invalidates every tail
+    blockCounter += 2;
+}
+
+void PartitionedConvolver::resetInStepWith(const PartitionedConvolver& other) noexcept
+{
+    reset();
+
+    if (other.layout != layout || other.partitionSize != partitionSize || other.stages.size() < stages.size())
+        return;
+
+    // The history is silent, so the part of the current block already taken in is zeros either way.
+    // Prepared for shorter IRs, the last stage may have fewer partitions, so its history slot wraps sooner
+    for (size_t s = 0; s < stages.size(); ++s)
+    {
+        jassert(other.stages[s].partitionSize == stages[s].partitionSize && other.stages[s].offset == stages[s].offset);
+        stages[s].inputPosition = other.stages[s].inputPosition;
+        stages[s].currentSegment = other.stages[s].currentSegment % stages[s].maxPartitions;
+        stages[s].ringPosition = other.stages[s].ringPosition;
+    }
+}
+
+//==============================================================================
+std::unique_ptr<PartitionedConvolver::Kernel> PartitionedConvolver::createKernel(const juce::AudioBuffer<float>& impulseResponse) const
+{
+    if (!isPrepared() || impulseResponse.getNumChannels() <= 0 || impulseResponse.getNumSamples() <= 0)
+        return nullptr;
+
+    // Short IRs can be cheaper as a plain FIR than as partitions, depending on the block size
+    const auto irLength = juce::jmin(impulseResponse.getNumSamples(), preparedIRLength);
+    return buildKernel(impulseResponse, shouldUseDirectFIR(irLength) ? Path::directFIR : Path::fft);
+}
+
+std::unique_ptr<PartitionedConvolver::Kernel> PartitionedConvolver::createCombinedKernel(const juce::AudioBuffer<float>& partitioned,
+                                                                                         const juce::AudioBuffer<float>& direct) const
+{
+    if (!isPrepared())
+        return nullptr;
+
+    const auto directLength = juce::jmin(direct.getNumSamples(), kMaxDirectFIRLength);
+
+    if (partitioned.getNumChannels() <= 0 || partitioned.getNumSamples() <= 0)
+        return (direct.getNumChannels() > 0 && directLength > 0) ? buildKernel(direct, Path::directFIR) : nullptr;
+
+    auto kernel = buildKernel(partitioned, Path::fft);
+    if (directLength == 0 || direct.getNumChannels() <= 0)
+        return kernel;
+
+    // The direct-form IRs join the head whole, exactly as they ran in their own kernels
+    const auto combinedHeadLength = juce::jmax(kernel->headLength, directLength);
+    std::vector<float> combinedHead(static_cast<size_t>(kernel->numChannels * combinedHeadLength), 0.0f);
+
+    for (int ch = 0; ch < kernel->numChannels; ++ch)
+    {
+        auto* head = combinedHead.data() + ch * combinedHeadLength;
+
+        if (kernel->headLength > 0)
+            juce::FloatVectorOperations::copy(head, kernel->head.data() + ch * kernel->headLength, kernel->headLength);
+
+        juce::FloatVectorOperations::add(head, direct.getReadPointer(juce::jmin(ch, direct.getNumChannels() - 1)),
+                                         directLength);
+    }
+
+    kernel->head = std::move(combinedHead);
+    kernel->headLength = combinedHeadLength;
+    kernel->length = juce::jmax(kernel->length, directLength);
+    return kernel;
+}
+
+std::unique_ptr<PartitionedConvolver::Kernel> PartitionedConvolver::buildKernel(const juce::AudioBuffer<float>& impulseResponse,
+                                                                                Path path) const
+{
+    auto kernel = std::make_unique<Kernel>();
+    kernel->layout = layout;
+    kernel->partitionSize = partitionSize;
+    kernel->numChannels = juce::jmin(impulseResponse.getNumChannels(), numChannels);
+
+    const auto irLength = juce::jmin(impulseResponse.getNumSamples(),
+                                     path == Path::directFIR ? kMaxDirectFIRLength : preparedIRLength);
+
+    kernel->path = path;
+    kernel->length = irLength;
+    kernel->headLength = (kernel->path == Path::directFIR) ? irLength : juce::jmin(headLength, irLength);
+
+    if (kernel->headLength > 0)
+    {
+        kernel->head.assign(static_cast<size_t>(kernel->numChannels * kernel->headLength), 0.0f);
+
+        for (int ch = 0; ch < kernel->numChannels; ++ch)
+            juce::FloatVectorOperations::copy(kernel->head.data() + ch * kernel->headLength,
+                                              impulseResponse.getReadPointer(ch),
+                                              kernel->headLength);
+    }
+
+    const auto largestFFT = stages.empty() ? 0 : stages.back().fftSize;
+    std::vector<float> segment(static_cast<size_t>(largestFFT), 0.0f);
+    std::vector<float> scratch(static_cast<size_t>(largestFFT * 2), 0.0f);
+
+    // Kernels are built on the loader and composite threads while the audio thread transforms;
+    // sharing the stages' FFTs would make both wait on the fallback engine's lock
+    std::unique_ptr<juce::dsp::FFT> fft;
+
+    kernel->stages.resize(stages.size());
+
+    for (size_t s = 0; s < stages.size(); ++s)
+    {
+        const auto& stage = stages[s];
+        auto& spectra = kernel->stages[s];
+
+        const auto stageSamples = (kernel->path == Path::directFIR) ? 0 : irLength - stage.offset;
+        spectra.spectrumSize = stage.spectrumSize;
+        spectra.numPartitions = juce::jlimit(0, stage.maxPartitions,
+                                             (stageSamples + stage.partitionSize - 1) / stage.partitionSize);
+
+        if (spectra.numPartitions == 0)
+            continue;
+
+        if (fft == nullptr || fft->getSize() != stage.fftSize)
+            fft = std::make_unique<juce::dsp::FFT>(getFFTOrder(stage.fftSize));
+
+        spectra.spectra.assign(static_cast<size_t>(kernel->numChannels * spectra.numPartitions * stage.spectrumSize), 0.0f);
+
+        for (int ch = 0; ch < kernel->numChannels; ++ch)
+        {
+            const auto* irData = impulseResponse.getReadPointer(ch);
+
+            for (int partition = 0; partition < spectra.numPartitions; ++partition)
+            {
+                const auto start = stage.offset + partition * stage.partitionSize;
+                const auto length = juce::jmin(stage.partitionSize, irLength - start);
+
+                std::fill(segment.begin(), segment.end(), 0.0f);
+                juce::FloatVectorOperations::copy(segment.data(), irData + start, length);
+
+                forwardTransform(stage, *fft, segment.data(), spectra.getPartition(ch, partition), scratch.data());
+            }
+        }
+    }
+
+    return kernel;
+}
+
+void PartitionedConvolver::setKernel(int kernelIndex, const Kernel* kernel) noexcept
+{
+    if (kernelIndex < 0 || kernelIndex >= static_cast<int>(kernels.size()))
+        return;
+
+    // Kernels built for a different layout can't be used until they're rebuilt
+    if (kernel != nullptr && !canRun(*kernel))
+        kernel = nullptr;
+
+    // Spread-out work may still read the outgoing kernel, and it can be freed once this returns
+    for (size_t s = 0; s < stages.size(); ++s)
+        if (stages[s].work.pending)
+            finishStageWork(static_cast<int>(s));
+
+    kernels[static_cast<size_t>(kernelIndex)] = kernel;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        kernelTailStamps[static_cast<size_t>(kernelIndex * numChannels + ch)] = blockCounter - 1;
+}
+
+bool PartitionedConvolver::canRun(const Kernel& kernel) const noexcept
+{
+    if (kernel.layout != layout || kernel.partitionSize != partitionSize || kernel.stages.size() < stages.size())
+        return false;
+
+    // Stages are laid out the same way whatever the IR length, so a convolver prepared for longer
+    // IRs only adds stages (or partitions to the last one) that a short enough kernel leaves empty
+    for (size_t s = 0; s < kernel.stages.size(); ++s)
+        if (kernel.stages[s].numPartitions > (s < stages.size() ? stages[s].maxPartitions : 0))
+            return false;
+
+    return true;
+}
+
+int PartitionedConvolver::getActiveKernelLength(const float* kernelWeights) const noexcept
+{
+    int length = 0;
+
+    for (size_t k = 0; k < kernels.size(); ++k)
+    {
+        const auto* kernel = kernels[k];
+        if (kernel == nullptr || (kernelWeights != nullptr && kernelWeights[k] == 0.0f))
+            continue;
+
+        length = juce::jmax(length, kernel->headLength);
+
+        for (size_t s = 0; s < stages.size(); ++s)
+            if (kernel->stages[s].numPartitions > 0)
+                length = juce::jmax(length, stages[s].offset + kernel->stages[s].numPartitions * stages[s].partitionSize);
+    }
+
+    return length;
+}
+
+bool PartitionedConvolver::areActiveKernelsMono(const float* kernelWeights) const noexcept
+{
+    for (size_t k = 0; k < kernels.size(); ++k)
+        if (kernels[k] != nullptr && kernelWeights[k] != 0.0f && kernels[k]->numChannels > 1)
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+void PartitionedConvolver::process(const float* const* input, float* const* output,
+                                   int numChannelsToProcess, int numSamples,
+                                   const float* kernelWeights) noexcept
+{
+    const auto numCh = juce::jmin(numChannelsToProcess, numChannels);
+
+    // Channels that sat out (dual-mono input) pick up where the last processed one is
+    if (numCh > activeChannels)
+        mirrorChannelState(activeChannels, numCh);
+
+    activeChannels = numCh;
+
+    for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        juce::FloatVectorOperations::clear(output[ch], numSamples);
+
+    processHead(input, output, numCh, numSamples, kernelWeights);
+
+    for (size_t s = 0; s < stages.size(); ++s)
+    {
+        if (stages[s].immediate)
+            processImmediateStage(stages[s], input, output, numCh, numSamples, kernelWeights);
+        else
+            processDeferredStage(static_cast<int>(s), input, output, numCh, numSamples, kernelWeights);
+    }
+}
+
+void PartitionedConvolver::processHead(const float* const* input, float* const* output,
+                                       int numChannelsToProcess, int numSamples,
+                                       const float* kernelWeights) noexcept
+{
+    // The weighted heads are summed once per call, so the FIR cost doesn't grow with the slot count
+    int numTaps = 0;
+    for (size_t k = 0; k < kernels.size(); ++k)
+        if (kernels[k] != nullptr && kernelWeights[k] != 0.0f)
+            numTaps = juce::jmax(numTaps, kernels[k]->headLength);
+
+    for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        juce::FloatVectorOperations::clear(headTaps.data() + ch * kMaxDirectFIRLength, numTaps);
+
+    for (size_t k = 0; k < kernels.size(); ++k)
+    {
+        const auto* kernel = kernels[k];
+        const auto weight = kernelWeights[k];
+
+        if (kernel == nullptr || weight == 0.0f || kernel->headLength == 0)
+            continue;
+
+        for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        {
+            const auto kernelChannel = juce::jmin(ch, kernel->numChannels - 1);
+            juce::FloatVectorOperations::addWithMultiply(headTaps.data() + ch * kMaxDirectFIRLength,
+                                                         kernel->head.data() + kernelChannel * kernel->headLength,
+                                                         weight, kernel->headLength);
+        }
+    }
+
+    // The history is always fed, so a longer FIR can take over at any time
+    const auto historyLength = kMaxDirectFIRLength - 1;
+    const auto historyStride = historyLength + kHeadHistoryBlock;
+
+    for (int numProcessed = 0; numProcessed < numSamples;)
+    {
+        const auto numToProcess = juce::jmin(kHeadChunk, numSamples - numProcessed);
+
+        // Slide the newest samples back to the front only once the buffer has filled up
+        if (headWritePosition + numToProcess > historyStride)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* history = headHistory.data() + ch * historyStride;
+                std::copy(history + headWritePosition - historyLength, history + headWritePosition, history);
+            }
+
+            headWritePosition = historyLength;
+        }
+
+        for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        {
+            auto* history = headHistory.data() + ch * historyStride;
+            const auto* taps = headTaps.data() + ch * kMaxDirectFIRLength;
+
+            juce::FloatVectorOperations::copy(history + headWritePosition, input[ch] + numProcessed, numToProcess);
+
+            // One vector multiply-add per tap across the whole chunk
+            for (int tap = 0; tap < numTaps; ++tap)
+                juce::FloatVectorOperations::addWithMultiply(output[ch] + numProcessed,
+                                                             history + headWritePosition - tap,
+                                                             taps[tap], numToProcess);
+        }
+
+        headWritePosition += numToProcess;
+        numProcessed += numToProcess;
+    }
+}
+
+void PartitionedConvolver::processImmediateStage(Stage& stage, const float* const* input, float* const* output,
+                                                 int numChannelsToProcess, int numSamples,
+                                                 const float* kernelWeights) noexcept
+{
+    const auto numKernels = static_cast<int>(kernels.size());
+    const auto spectrumSize = stage.spectrumSize;
+    int numProcessed = 0;
+
+    while (numProcessed < numSamples)
+    {
+        const auto numToProcess = juce::jmin(numSamples - numProcessed, stage.partitionSize - stage.inputPosition);
+
+        for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        {
+            auto& state = stage.channels[static_cast<size_t>(ch)];
+
+            // Transform the (possibly partial) current block once for every kernel
+            juce::FloatVectorOperations::copy(state.inputBlock.data() + stage.inputPosition,
+                                              input[ch] + numProcessed, numToProcess);
+
+            auto* currentSpectrum = state.history.data() + stage.currentSegment * spectrumSize;
+            forwardTransform(stage, *stage.fft, state.inputBlock.data(), currentSpectrum, state.fftBuffer.data());
+
+            if (ch == numChannelsToProcess - 1)
+                mirrorHistorySegment(stage, ch, stage.currentSegment);
+
+            juce::FloatVectorOperations::clear(accumulator.data(), spectrumSize);
+
+            for (int k = 0; k < numKernels; ++k)
+            {
+                const auto* kernel = kernels[static_cast<size_t>(k)];
+                const auto weight = kernelWeights[k];
+
+                if (kernel == nullptr || weight == 0.0f || kernel->stages.front().numPartitions == 0)
+                    continue;
+
+                const auto tailIndex = static_cast<size_t>(k * numChannels + ch);
+                if (kernelTailStamps[tailIndex] != blockCounter)
+                    accumulateTail(k, ch);
+
+                // Current block against the first partition, on top of the cached tail
+                const auto kernelChannel = juce::jmin(ch, kernel->numChannels - 1);
+                juce::FloatVectorOperations::copy(slotScratch.data(),
+                                                  kernelTails.data() + tailIndex * static_cast<size_t>(spectrumSize),
+                                                  spectrumSize);
+                multiplyAccumulate(stage.numBins, currentSpectrum,
+                                   kernel->stages.front().getPartition(kernelChannel, 0), slotScratch.data());
+
+                // Gain and phase invert are folded in here, before the single inverse FFT
+                juce::FloatVectorOperations::addWithMultiply(accumulator.data(), slotScratch.data(), weight, spectrumSize);
+            }
+
+            inverseTransform(stage, *stage.fft, accumulator.data(), state.fftBuffer.data());
+
+            juce::FloatVectorOperations::add(output[ch] + numProcessed, state.fftBuffer.data() + stage.inputPosition, numToProcess);
+            juce::FloatVectorOperations::add(output[ch] + numProcessed, state.overlap.data() + stage.inputPosition, numToProcess);
+        }
+
+        stage.inputPosition += numToProcess;
+
+        if (stage.inputPosition == stage.partitionSize)
+        {
+            for (int ch = 0; ch < numChannelsToProcess; ++ch)
+            {
+                auto& state = stage.channels[static_cast<size_t>(ch)];
+                juce::FloatVectorOperations::copy(state.overlap.data(), state.fftBuffer.data() + stage.partitionSize,
+                                                  stage.partitionSize);
+                std::fill(state.inputBlock.begin(), state.inputBlock.end(), 0.0f);
+            }
+
+            stage.inputPosition = 0;
+            stage.currentSegment = (stage.currentSegment > 0) ? (stage.currentSegment - 1) : (stage.maxPartitions - 1);
+            ++blockCounter;
+        }
+
+        numProcessed += numToProcess;
+    }
+}
+
+void PartitionedConvolver::processDeferredStage(int stageIndex, const float* const* input, float* const* output,
+                                                int numChannelsToProcess, int numSamples,
+                                                const float* kernelWeights) noexcept
+{
+    auto& stage = stages[static_cast<size_t>(stageIndex)];
+    const auto ringMask = stage.ringSize - 1;
+    int numProcessed = 0;
+
+    while (numProcessed < numSamples)
+    {
+        const auto numToProcess = juce::jmin(numSamples - numProcessed, stage.partitionSize - stage.inputPosition);
+        const auto firstPart = juce::jmin(numToProcess, stage.ringSize - stage.ringPosition);
+
+        // Keep the previous block's work on schedule before reading what it produces
+        if (stage.work.pending)
+            advanceStageWork(stageIndex, numToProcess);
+
+        for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        {
+            auto& state = stage.channels[static_cast<size_t>(ch)];
+            auto* ring = state.outputRing.data();
+            auto* out = output[ch] + numProcessed;
+
+            // Collect what earlier blocks left for these samples, then free the space for later ones
+            juce::FloatVectorOperations::add(out, ring + stage.ringPosition, firstPart);
+            juce::FloatVectorOperations::clear(ring + stage.ringPosition, firstPart);
+
+            if (firstPart < numToProcess)
+            {
+                juce::FloatVectorOperations::add(out + firstPart, ring, numToProcess - firstPart);
+                juce::FloatVectorOperations::clear(ring, numToProcess - firstPart);
+            }
+
+            juce::FloatVectorOperations::copy(state.inputBlock.data() + stage.inputPosition,
+                                              input[ch] + numProcessed, numToProcess);
+        }
+
+        stage.inputPosition += numToProcess;
+        stage.ringPosition = (stage.ringPosition + numToProcess) & ringMask;
+
+        // The worker's result is due before the ring reaches the samples it covers
+        if (stage.background != nullptr && stage.background->outstandingJob >= 0)
+        {
+            stage.background->outstandingElapsed += numToProcess;
+
+            if (stage.background->outstandingElapsed >= stage.workBudget)
+                collectBackgroundJob(stageIndex);
+        }
+
+        if (stage.inputPosition == stage.partitionSize)
+        {
+            if (stage.background != nullptr)
+                pushBackgroundJob(stageIndex, numChannelsToProcess, kernelWeights);
+            else
+                beginStageWork(stageIndex, numChannelsToProcess, kernelWeights);
+
+            // No slack (the first stage): the output is due straight away
+            if (stage.workBudget == 0)
+                finishStageWork(stageIndex);
+
+            stage.inputPosition = 0;
+            stage.currentSegment = (stage.currentSegment > 0) ? (stage.currentSegment - 1) : (stage.maxPartitions - 1);
+        }
+
+        numProcessed += numToProcess;
+    }
+}
+
+//==============================================================================
+void PartitionedConvolver::beginStageWork(int stageIndex, int numChannelsToProcess, const float* kernelWeights) noexcept
+{
+    auto& stage = stages[static_cast<size_t>(stageIndex)];
+    auto& work = stage.work;
+
+    // The budget never exceeds one partition, so this only catches up if a block was cut short
+    if (work.pending)
+        finishStageWork(stageIndex);
+
+    // Swapping keeps both blocks zero padded and lets the next block fill in while this one is worked on
+    for (int ch = 0; ch < numChannelsToProcess; ++ch)
+    {
+        auto& state = stage.channels[static_cast<size_t>(ch)];
+        std::swap(state.inputBlock, state.pendingBlock);
+    }
+
+    std::copy(kernelWeights, kernelWeights + work.weights.size(), work.weights.begin());
+
+    work.pending = true;
+    work.phase = WorkPhase::transform;
+    work.numChannels = numChannelsToProcess;
+    work.channel = 0;
+    work.kernel = 0;
+    work.partition = 0;
+    work.segment = stage.currentSegment;
+    work.ringPosition = stage.ringPosition;
+    work.elapsedSamples = 0;
+    work.costDone = 0;
+
+    int costPerChannel = kTransformCost * 2;
+    for (int k = 0; k < static_cast<int>(kernels.size()); ++k)
+        if (kernelHasStageWork(work, stageIndex, k))
+            costPerChannel += kernels[static_cast<size_t>(k)]->stages[static_cast<size_t>(stageIndex)].numPartitions;
+
+    work.costTotal = costPerChannel * numChannelsToProcess;
+}
+
+void PartitionedConvolver::advanceStageWork(int stageIndex, int numSamples) noexcept
+{
+    auto& stage = stages[static_cast<size_t>(stageIndex)];
+    auto& work = stage.work;
+
+    // Do the share of the work that corresponds to the time elapsed since the block completed
+    work.elapsedSamples = juce::jmin(work.elapsedSamples + numSamples, stage.workBudget);
+    const auto target = static_cast<int>(static_cast<juce::int64>(work.costTotal) * work.elapsedSamples
+                                         / juce::jmax(1, stage.workBudget));
+
+    while (work.pending && work.costDone < target)
+        work.costDone += runWorkUnit(stageIndex);
+}
+
+void PartitionedConvolver::finishStageWork(int stageIndex) noexcept
+{
+    auto& work = stages[static_cast<size_t>(stageIndex)].work;
+
+    while (work.pending)
+        work.costDone += runWorkUnit(stageIndex);
+}
+
+int PartitionedConvolver::runWorkUnit(int stageIndex) noexcept
+{
+    auto& stage = stages[static_cast<size_t>(stageIndex)];
+    auto& work = stage.work;
+    auto& state = stage.channels[static_cast<size_t>(work.channel)];
+    const auto spectrumSize = stage.spectrumSize;
+
+    switch (work.phase)
+    {
+        case WorkPhase::transform:
+        {
+            forwardTransform(stage, *stage.fft, state.pendingBlock.data(),
+                             state.history.data() + work.segment * spectrumSize, state.fftBuffer.data());
+            juce::FloatVectorOperations::clear(state.workAccumulator.data(), spectrumSize);
+
+            if (work.channel == work.numChannels - 1)
+                mirrorHistorySegment(stage, work.channel, work.segment);
+
+            work.phase = WorkPhase::multiply;
+            work.kernel = 0;
+            work.partition = 0;
+
+            while (work.kernel < static_cast<int>(kernels.size()) && !kernelHasStageWork(work, stageIndex, work.kernel))
+                ++work.kernel;
+
+            if (work.kernel == static_cast<int>(kernels.size()))
+                work.phase = WorkPhase::inverse;
+
+            return kTransformCost;
+        }
+
+        case WorkPhase::multiply:
+        {
+            const auto* kernel = kernels[static_cast<size_t>(work.kernel)];
+            const auto& spectra = kernel->stages[static_cast<size_t>(stageIndex)];
+            const auto kernelChannel = juce::jmin(work.channel, kernel->numChannels - 1);
+
+            if (work.partition == 0)
+                juce::FloatVectorOperations::clear(state.workScratch.data(), spectrumSize);
+
+            const auto segment = (work.segment + work.partition) % stage.maxPartitions;
+            multiplyAccumulate(stage.numBins, state.history.data() + segment * spectrumSize,
+                               spectra.getPartition(kernelChannel, work.partition), state.workScratch.data());
+
+            if (++work.partition == spectra.numPartitions)
+            {
+                // Gain and phase invert are folded in here, before the single inverse FFT
+                juce::FloatVectorOperations::addWithMultiply(state.workAccumulator.data(), state.workScratch.data(),
+                                                             work.weights[static_cast<size_t>(work.kernel)], spectrumSize);
+                work.partition = 0;
+
+                do
+                    ++work.kernel;
+                while (work.kernel < static_cast<int>(kernels.size()) && !kernelHasStageWork(work, stageIndex, work.kernel));
+
+                if (work.kernel == static_cast<int>(kernels.size()))
+                    work.phase = WorkPhase::inverse;
+            }
+
+            return 1;
+        }
+
+        case WorkPhase::inverse:
+        default:
+        {
+            inverseTransform(stage, *stage.fft, state.workAccumulator.data(), state.fftBuffer.data());
+
+            // The block began partitionSize samples before it completed, and its output
+            // starts 'offset' samples after that
+            const auto ringMask = stage.ringSize - 1;
+            const auto writePosition = (work.ringPosition + stage.offset - stage.partitionSize) & ringMask;
+            const auto firstPart = juce::jmin(stage.fftSize, stage.ringSize - writePosition);
+            auto* ring = state.outputRing.data();
+
+            juce::FloatVectorOperations::add(ring + writePosition, state.fftBuffer.data(), firstPart);
+
+            if (firstPart < stage.fftSize)
+                juce::FloatVectorOperations::add(ring, state.fftBuffer.data() + firstPart, stage.fftSize - firstPart);
+
+            work.phase = WorkPhase::transform;
+            if (++work.channel == work.numChannels)
+                work.pending = false;
+
+            return kTransformCost;
+        }
+    }
+}
+
+bool PartitionedConvolver::kernelHasStageWork(const StageWork& work, int stageIndex, int kernelIndex) const noexcept
+{
+    const auto* kernel = kernels[static_cast<size_t>(kernelIndex)];
+
+    return kernel != nullptr
+        && work.weights[static_cast<size_t>(kernelIndex)] != 0.0f
+        && kernel->stages[static_cast<size_t>(stageIndex)].numPartitions > 0;
+}
+
+//==============================================================================
+void PartitionedConvolver::pushBackgroundJob(int stageIndex, int numChannelsToProcess, const float* kernelWeights) noexcept
+{
+    auto& stage = stages[static_cast<size_t>(stageIndex)];
+    auto& background = *stage.background;
+    const auto sequence = background.nextSequence.load();
+
+    BackgroundJob* job = nullptr;
+    for (int i = 0; i < kNumBackgroundJobs && job == nullptr; ++i)
+    {
+        if (background.jobs[static_cast<size_t>(i)].state.load() == jobFree)
+        {
+            job = &background.jobs[static_cast<size_t>(i)];
+            background.outstandingJob = i;
+        }
+    }
+
+    // Every slot is still held by a worker that has fallen behind: this block stays silent
+    if (job == nullptr)
+    {
+        missedDeadlines.fetch_add(1);
+        background.nextSequence.store(sequence + 1);
+        return;
+    }
+
+    job->sequence.store(sequence);
+    job->numChannels = numChannelsToProcess;
+    job->ringPosition = stage.ringPosition;
+
+    for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        juce::FloatVectorOperations::copy(job->input.data() + ch * stage.partitionSize,
+                                          stage.channels[static_cast<size_t>(ch)].inputBlock.data(),
+                                          stage.partitionSize);
+
+    std::copy(kernelWeights, kernelWeights + job->weights.size(), job->weights.begin());
+    std::copy(kernels.begin(), kernels.end(), job->kernels.begin());
+
+    job->state.store(jobQueued);
+    background.outstandingElapsed = 0;
+    background.nextSequence.store(sequence + 1);
+}
+
+void PartitionedConvolver::collectBackgroundJob(int stageIndex) noexcept
+{
+    auto& stage = stages[static_cast<size_t>(stageIndex)];
+    auto& background = *stage.background;
+    auto& job = background.jobs[static_cast<size_t>(background.outstandingJob)];
+    background.outstandingJob = -1;
+
+    // The worker polls, so a job it hasn't finished yet is done within a few milliseconds
+    if (waitForLateJobs.load())
+        while (job.state.load() == jobQueued || job.state.load() == jobRunning)
+            std::this_thread::yield();
+
+    // Late: take the job back if the worker never started it, otherwise leave it to be freed
+    auto expected = static_cast<int>(jobQueued);
+    if (job.state.compare_exchange_strong(expected, jobFree)
+        || (expected == jobRunning && job.state.compare_exchange_strong(expected, jobAbandoned)))
+    {
+        missedDeadlines.fetch_add(1);
+        return;
+    }
+
+    jassert(expected == jobDone);
+
+    const auto ringMask = stage.ringSize - 1;
+    const auto writePosition = (job.ringPosition + stage.offset - stage.partitionSize) & ringMask;
+    const auto firstPart = juce::jmin(stage.fftSize, stage.ringSize - writePosition);
+
+    // A job queued before the input stopped being dual-mono covers the new channels too
+    for (int ch = 0; ch < juce::jmax(job.numChannels, activeChannels); ++ch)
+    {
+        auto* ring = stage.channels[static_cast<size_t>(ch)].outputRing.data();
+        const auto* result = job.output.data() + juce::jmin(ch, job.numChannels - 1) * stage.fftSize;
+
+        juce::FloatVectorOperations::add(ring + writePosition, result, firstPart);
+
+        if (firstPart < stage.fftSize)
+            juce::FloatVectorOperations::add(ring, result + firstPart, stage.fftSize - firstPart);
+    }
+
+    job.state.store(jobFree);
+}
+
+void PartitionedConvolver::cancelBackgroundJobs(Stage& stage) noexcept
+{
+    for (auto& job : stage.background->jobs)
+    {
+        auto expected = static_cast<int>(jobQueued);
+        if (job.state.compare_exchange_strong(expected, jobFree))
+            continue;
+
+        if (expected == jobRunning && job.state.compare_exchange_strong(expected, jobAbandoned))
+            continue;
+
+        if (expected == jobDone)
+            job.state.store(jobFree);
+    }
+
+    stage.background->outstandingJob = -1;
+}
+
+bool PartitionedConvolver::runBackgroundJobs() noexcept
+{
+    bool didWork = false;
+
+    for (size_t s = 0; s < stages.size(); ++s)
+    {
+        if (stages[s].background == nullptr)
+            continue;
+
+        auto& background = *stages[s].background;
+
+        // Oldest first: the history has to be filled in the order the blocks arrived
+        BackgroundJob* next = nullptr;
+        for (auto& job : background.jobs)
+            if (job.state.load() == jobQueued
+                && (next == nullptr || static_cast<int>(job.sequence.load() - next->sequence.load()) < 0))
+                next = &job;
+
+        if (next == nullptr)
+            continue;
+
+        auto expected = static_cast<int>(jobQueued);
+        if (!next->state.compare_exchange_strong(expected, jobRunning))
+            continue; // cancelled by the audio thread in the meantime
+
+        processBackgroundJob(static_cast<int>(s), *next);
+
+        expected = jobRunning;
+        if (!next->state.compare_exchange_strong(expected, jobDone))
+            next->state.store(jobFree); // abandoned while it ran
+
+        didWork = true;
+    }
+
+    return didWork;
+}
+
+void PartitionedConvolver::processBackgroundJob(int stageIndex, BackgroundJob& job) noexcept
+{
+    auto& stage = stages[static_cast<size_t>(stageIndex)];
+    auto& background = *stage.background;
+    const auto spectrumSize = stage.spectrumSize;
+    const auto sequence = job.sequence.load();
+
+    if (background.resetPending.exchange(false))
+    {
+        for (auto& state : stage.channels)
+            std::fill(state.history.begin(), state.history.end(), 0.0f);
+
+        background.hasLastSequence = false;
+    }
+
+    // Blocks that were dropped or cancelled never reached the history, so they count as silence
+    if (background.hasLastSequence)
+    {
+        int numSkipped = 0;
+        for (auto missing = background.lastSequence + 1; missing != sequence && numSkipped < stage.maxPartitions; ++missing, ++numSkipped)
+            for (auto& state : stage.channels)
+                juce::FloatVectorOperations::clear(state.history.data() + getSegmentForSequence(stage, missing) * spectrumSize,
+                                                   spectrumSize);
+    }
+
+    background.lastSequence = sequence;
+    background.hasLastSequence = true;
+
+    const auto segment = getSegmentForSequence(stage, sequence);
+
+    for (int ch = 0; ch < job.numChannels; ++ch)
+    {
+        auto& state = stage.channels[static_cast<size_t>(ch)];
+
+        // pendingBlock is the worker's zero-padded transform input for background stages
+        juce::FloatVectorOperations::copy(state.pendingBlock.data(), job.input.data() + ch * stage.partitionSize,
+                                          stage.partitionSize);
+        forwardTransform(stage, *background.fft, state.pendingBlock.data(),
+                         state.history.data() + segment * spectrumSize, state.fftBuffer.data());
+
+        if (ch == job.numChannels - 1)
+            mirrorHistorySegment(stage, ch, segment);
+
+        juce::FloatVectorOperations::clear(state.workAccumulator.data(), spectrumSize);
+
+        for (size_t k = 0; k < job.kernels.size(); ++k)
+        {
+            const auto* kernel = job.kernels[k];
+            const auto weight = job.weights[k];
+
+            if (kernel == nullptr || weight == 0.0f)
+                continue;
+
+            const auto& spectra = kernel->stages[static_cast<size_t>(stageIndex)];
+            const auto kernelChannel = juce::jmin(ch, kernel->numChannels - 1);
+
+            if (spectra.numPartitions == 0)
+                continue;
+
+            juce::FloatVectorOperations::clear(state.workScratch.data(), spectrumSize);
+
+            for (int partition = 0; partition < spectra.numPartitions; ++partition)
+                multiplyAccumulate(stage.numBins,
+                                   state.history.data() + ((segment + partition) % stage.maxPartitions) * spectrumSize,
+                                   spectra.getPartition(kernelChannel, partition), state.workScratch.data());
+
+            juce::FloatVectorOperations::addWithMultiply(state.workAccumulator.data(), state.workScratch.data(),
+                                                         weight, spectrumSize);
+        }
+
+        inverseTransform(stage, *background.fft, state.workAccumulator.data(), state.fftBuffer.data());
+        juce::FloatVectorOperations::copy(job.output.data() + ch * stage.fftSize, state.fftBuffer.data(), stage.fftSize);
+    }
+}
+
+//==============================================================================
+void PartitionedConvolver::mirrorHistorySegment(Stage& stage, int sourceChannel, int segment) noexcept
+{
+    // Idle channels keep an identical spectrum history, so they can rejoin at any block
+    const auto spectrumSize = stage.spectrumSize;
+    const auto* source = stage.channels[static_cast<size_t>(sourceChannel)].history.data() + segment * spectrumSize;
+
+    for (int ch = sourceChannel + 1; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::copy(stage.channels[static_cast<size_t>(ch)].history.data() + segment * spectrumSize,
+                                          source, spectrumSize);
+}
+
+void PartitionedConvolver::mirrorChannelState(int numSourceChannels, int numChannelsToProcess) noexcept
+{
+    const auto source = juce::jmax(0, numSourceChannels - 1);
+    const auto historyStride = kMaxDirectFIRLength - 1 + kHeadHistoryBlock;
+    const auto* sourceHistory = headHistory.data() + source * historyStride;
+
+    for (int ch = numSourceChannels; ch < numChannelsToProcess; ++ch)
+    {
+        std::copy(sourceHistory, sourceHistory + headWritePosition, headHistory.data() + ch * historyStride);
+
+        // Tails are rebuilt from the mirrored history on the next call
+        for (size_t k = 0; k < kernels.size(); ++k)
+            kernelTailStamps[k * static_cast<size_t>(numChannels) + static_cast<size_t>(ch)] = blockCounter - 1;
+    }
+
+    for (auto& stage : stages)
+    {
+        const auto& from = stage.channels[static_cast<size_t>(source)];
+
+        for (int ch = numSourceChannels; ch < numChannelsToProcess; ++ch)
+        {
+            auto& to = stage.channels[static_cast<size_t>(ch)];
+            std::copy(from.inputBlock.begin(), from.inputBlock.end(), to.inputBlock.begin());
+            std::copy(from.overlap.begin(), from.overlap.end(), to.overlap.begin());
+            std::copy(from.outputRing.begin(), from.outputRing.end(), to.outputRing.begin());
+
+            // The worker owns a background stage's pending block
+            if (stage.background == nullptr)
+                std::copy(from.pendingBlock.begin(), from.pendingBlock.end(), to.pendingBlock.begin());
+        }
+
+        // Work still spread over the coming blocks now runs for the new channels as well
+        auto& work = stage.work;
+        if (work.pending && work.numChannels < numChannelsToProcess)
+        {
+            work.costTotal = work.costTotal / work.numChannels * numChannelsToProcess;
+            work.numChannels = numChannelsToProcess;
+        }
+    }
+}
+
+int PartitionedConvolver::getSegmentForSequence(const Stage& stage, juce::uint32 sequence) const noexcept
+{
+    // Matches the audio-thread stages, where block n lands n slots back from slot 0
+    const auto position = static_cast<int>(sequence % static_cast<juce::uint32>(stage.maxPartitions));
+    return position == 0 ? 0 : stage.maxPartitions - position;
+}
+
+void PartitionedConvolver::waitForBackgroundJobs() const
+{
+    const auto timeout = juce::Time::getMillisecondCounter() + 1000;
+
+    for (const auto& stage : stages)
+    {
+        if (stage.background == nullptr)
+            continue;
+
+        const auto& background = *stage.background;
+        const auto sequenceLimit = background.nextSequence.load();
+
+        for (const auto& job : background.jobs)
+        {
+            for (;;)
+            {
+                const auto state = job.state.load();
+                if (state == jobFree || state == jobDone)
+                    break;
+
+                // Queued after the call, so it already sees the current kernels
+                if (static_cast<int>(job.sequence.load() - sequenceLimit) >= 0)
+                    break;
+
+                // A stopped worker never picks its queue up again; prepare() cancels it
+                if (!backgroundWorker.isThreadRunning())
+                    break;
+
+                if (juce::Time::getMillisecondCounter() > timeout)
+                {
+                    jassertfalse;
+                    return;
+                }
+
+                juce::Thread::sleep(1);
+            }
+        }
+    }
+}
+
+//==============================================================================
+PartitionedConvolver::BackgroundWorker::BackgroundWorker(PartitionedConvolver& ownerConvolver)
+    : juce::Thread("KingsCab Convolution Tail"), owner(ownerConvolver)
+{
+}
+
+PartitionedConvolver::BackgroundWorker::~BackgroundWorker()
+{
+    stopThread(1000);
+}
+
+void PartitionedConvolver::BackgroundWorker::run()
+{
+    // Polling keeps the audio thread's side of the hand-off to plain atomic stores
+    while (!threadShouldExit())
+        if (!owner.runBackgroundJobs())
+            wait(1);
+}
+
+//==============================================================================
+void PartitionedConvolver::forwardTransform(const Stage& stage, const juce::dsp::FFT& fft, const float* timeDomain,
+                                            float* spectrum, float* scratch) const noexcept
+{
+    juce::FloatVectorOperations::copy(scratch, timeDomain, stage.fftSize);
+    juce::FloatVectorOperations::clear(scratch + stage.fftSize, stage.fftSize);
+    fft.performRealOnlyForwardTransform(scratch, true);
+
+    // Split real/imaginary halves so the multiply-accumulate runs on contiguous vectors
+    auto* re = spectrum;
+    auto* im = spectrum + stage.numBins;
+    for (int bin = 0; bin < stage.numBins; ++bin)
+    {
+        re[bin] = scratch[bin * 2];
+        im[bin] = scratch[bin * 2 + 1];
+    }
+}
+
+void PartitionedConvolver::inverseTransform(const Stage& stage, const juce::dsp::FFT& fft,
+                                            const float* spectrum, float* scratch) const noexcept
+{
+    const auto* re = spectrum;
+    const auto* im = spectrum + stage.numBins;
+
+    for (int bin = 0; bin < stage.numBins; ++bin)
+    {
+        scratch[bin * 2] = re[bin];
+        scratch[bin * 2 + 1] = im[bin];
+    }
+
+    // Mirror the conjugate half; not every juce::dsp::FFT backend ignores it
+    for (int bin = stage.numBins; bin < stage.fftSize; ++bin)
+    {
+        scratch[bin * 2] = re[stage.fftSize - bin];
+        scratch[bin * 2 + 1] = -im[stage.fftSize - bin];
+    }
+
+    // juce::dsp::FFT scales the inverse transform by 1 / fftSize
+    fft.performRealOnlyInverseTransform(scratch);
+}
+
+int PartitionedConvolver::getFFTOrder(int fftSize) noexcept
+{
+    int order = 0;
+    while ((1 << order) < fftSize)
+        ++order;
+
+    return order;
+}
+
+void PartitionedConvolver::multiplyAccumulate(int numBins, const float* input, const float* impulse, float* output) noexcept
+{
+    const auto* inRe = input;
+    const auto* inIm = input + numBins;
+    const auto* irRe = impulse;
+    const auto* irIm = impulse + numBins;
+    auto* outRe = output;
+    auto* outIm = output + numBins;
+
+    juce::FloatVectorOperations::addWithMultiply(outRe, inRe, irRe, numBins);
+    juce::FloatVectorOperations::subtractWithMultiply(outRe, inIm, irIm, numBins);
+    juce::FloatVectorOperations::addWithMultiply(outIm, inRe, irIm, numBins);
+    juce::FloatVectorOperations::addWithMultiply(outIm, inIm, irRe, numBins);
+}
+
+void PartitionedConvolver::accumulateTail(int kernelIndex, int channel) noexcept
+{
+    const auto& stage = stages.front();
+    const auto* kernel = kernels[static_cast<size_t>(kernelIndex)];
+    const auto& state = stage.channels[static_cast<size_t>(channel)];
+    const auto tailIndex = static_cast<size_t>(kernelIndex * numChannels + channel);
+    auto* tail = kernelTails.data() + tailIndex * static_cast<size_t>(stage.spectrumSize);
+
+    juce::FloatVectorOperations::clear(tail, stage.spectrumSize);
+
+    // Partitions 1..n only see completed blocks, so this is done once per block
+    const auto& spectra = kernel->stages.front();
+    const auto kernelChannel = juce::jmin(channel, kernel->numChannels - 1);
+    auto segment = stage.currentSegment;
+
+    for (int partition = 1; partition < spectra.numPartitions; ++partition)
+    {
+        if (++segment >= stage.maxPartitions)
+            segment = 0;
+
+        multiplyAccumulate(stage.numBins, state.history.data() + segment * stage.spectrumSize,
+                           spectra.getPartition(kernelChannel, partition),
+                           tail);
+    }
+
+    kernelTailStamps[tailIndex] = blockCounter;
+}
@@ -0,0 +1,373 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * Multi-slot partitioned convolution with a shared input spectrum.
+ *
+ * Features:
+ * - The input is transformed once per block, regardless of how many IRs are active
+ * - Every slot's partitioned IR spectra are multiply-accumulated against the
+ *   shared input history with the slot gain/phase folded into the accumulation
+ * - A single inverse FFT per channel produces the summed wet signal
+ * - Zero added latency in both layouts:
+ *     uniform    - one partition size that follows the block size (same
+ *                  overlap-add scheme as juce::dsp::Convolution)
+ *     nonUniform - a direct-form FIR head, then FFT partitions that grow along
+ *                  the IR, so small host buffers no longer pay for thousands of
+ *                  tiny partitions on every block
+ * - Load-balanced non-uniform stages: each large partition's FFTs and
+ *   multiply-accumulates are spread over the blocks before its deadline, so
+ *   the per-block cost stays flat instead of spiking when big blocks complete
+ * - Optional background thread for the late tail: partitions of 1024 samples and
+ *   up are handed to a worker through lock-free job slots and collected one
+ *   partition later; a late result is dropped (silence for that block) and
+ *   counted, the audio thread never waits
+ * - Per-kernel path choice: IRs up to kMaxDirectFIRLength taps run as a
+ *   vectorised direct-form FIR when that measures cheaper than the FFT
+ *   partitions at the prepared block size
+ *
+ * Kernels are built off the audio thread with createKernel() and handed to the
+ * audio thread through setKernel(); the convolver never owns them.
+ */
+class PartitionedConvolver
+{
+public:
+    //==============================================================================
+    enum class Layout
+    {
+        uniform,
+        nonUniform
+    };
+
+    enum class Path
+    {
+        fft,        // partitioned (with the non-uniform direct-form head, if any)
+        directFIR   // the whole IR runs in the direct-form head
+    };
+
+    /** One partition size's worth of IR spectra. */
+    struct StageSpectra
+    {
+        int numPartitions = 0;
+        int spectrumSize = 0;
+        std::vector<float> spectra; // [channel][partition][re (bins) | im (bins)]
+
+        const float* getPartition(int channel, int partition) const noexcept;
+        float* getPartition(int channel, int partition) noexcept;
+    };
+
+    /** Frequency-domain IR, split to match the convolver's layout. */
+    struct Kernel
+    {
+        Layout layout = Layout::uniform;
+        Path path = Path::fft;
+        int partitionSize = 0;          // smallest partition, used to check the kernel still fits
+        int length = 0;                 // IR samples it covers; a convolver must be prepared for at least this
+        int numChannels = 0;
+        int headLength = 0;
+        std::vector<float> head;        // [channel][headLength] direct-form taps
+        std::vector<StageSpectra> stages;
+    };
+
+    //==============================================================================
+    PartitionedConvolver();
+    ~PartitionedConvolver();
+
+    //==============================================================================
+    /**
+     * Allocates every buffer needed for IRs up to maxIRLength. Returns true if
+     * existing kernels must be rebuilt (the layout changed, or the block size
+     * moved the direct-FIR / FFT trade-off); otherwise the convolver is only reset.
+     */
+    bool prepare(int maximumBlockSize, int numChannels, int maxIRLength, int numKernels, Layout layout);
+    void reset();
+
+    /**
+     * Clears the convolver like reset(), but lines its partitions up with another one prepared
+     * the same way, so both complete their blocks on the same samples. Weight changes then take
+     * effect at the same points in both, and one can cancel part of the other's output exactly.
+     * The other one may be prepared for longer IRs: this one's partitions are the first of its.
+     */
+    void resetInStepWith(const PartitionedConvolver& other) noexcept;
+
+    /** Moves the late non-uniform stages to a worker thread. Applied by the next prepare(). */
+    void setUseBackgroundThread(bool shouldUseBackgroundThread) noexcept { useBackgroundThread = shouldUseBackgroundThread; }
+
+    /**
+     * Offline the caller may block, so a late tail block is waited for instead of being played
+     * as silence. Any thread; applies from the next block due.
+     */
+    void setWaitForLateJobs(bool shouldWait) noexcept { waitForLateJobs.store(shouldWait); }
+
+    /** Stops the worker; call before destroying kernels the convolver may still reference. */
+    void stopBackgroundThread();
+
+    /**
+     * Blocks until no background job queued before this call can still read a kernel,
+     * so a kernel swapped out by setKernel() can be freed. Never call on the audio thread.
+     */
+    void waitForBackgroundJobs() const;
+
+    /** True if every kernel that would run with these weights has a single channel. */
+    bool areActiveKernelsMono(const float* kernelWeights) const noexcept;
+
+    /**
+     * How far back the input reaches into the output with these weights, in samples.
+     * With nullptr every installed kernel counts, weighted or not.
+     */
+    int getActiveKernelLength(const float* kernelWeights) const noexcept;
+
+    /** Tail blocks the worker didn't finish in time (or that had no free job slot). */
+    int getNumMissedDeadlines() const noexcept { return missedDeadlines.load(); }
+
+    Layout getLayout() const noexcept { return layout; }
+    int getPartitionSize() const noexcept { return partitionSize; }
+    int getMaxIRLength() const noexcept { return preparedIRLength; }
+    bool isPrepared() const noexcept { return partitionSize > 0; }
+
+    //==============================================================================
+    /** Builds a kernel for the current layout. Allocates, so never call on the audio thread. */
+    std::unique_ptr<Kernel> createKernel(const juce::AudioBuffer<float>& impulseResponse) const;
+
+    /**
+     * Builds one kernel equal to the sum of several createKernel() results: 'partitioned'
+     * is the weighted sum of the IRs that took the FFT path, 'direct' that of the IRs that
+     * run as a direct-form FIR. Each part keeps the path it had, so swapping between the
+     * separate kernels and the combined one is sample-exact. Allocates.
+     */
+    std::unique_ptr<Kernel> createCombinedKernel(const juce::AudioBuffer<float>& partitioned,
+                                                 const juce::AudioBuffer<float>& direct) const;
+
+    /**
+     * Installs (or removes, with nullptr) the kernel used for a slot. Audio thread only. Kernels
+     * from a convolver with the same layout and block size fit if they are no longer than the IRs
+     * this one was prepared for; any other kernel is ignored.
+     */
+    void setKernel(int kernelIndex, const Kernel* kernel) noexcept;
+
+    //==============================================================================
+    /**
+     * Convolves the input with every kernel whose weight is non-zero and writes
+     * the weighted sum to the output (replacing its contents). The input and
+     * output must not share memory.
+     *
+     * Processing fewer channels than were prepared (dual-mono input) keeps the
+     * idle channels in step with the last processed one, so they can come back
+     * on any later call without a glitch.
+     */
+    void process(const float* const* input, float* const* output,
+                 int numChannelsToProcess, int numSamples,
+                 const float* kernelWeights) noexcept;
+
+private:
+    //==============================================================================
+    struct ChannelState
+    {
+        std::vector<float> inputBlock;    // current block, zero padded to fftSize
+        std::vector<float> history;       // input spectra, one per partition
+        std::vector<float> fftBuffer;     // interleaved scratch for juce::dsp::FFT
+        std::vector<float> overlap;       // immediate stages: second half of the last completed block
+        std::vector<float> outputRing;    // deferred stages: overlap-added output, read as time passes
+
+        // Deferred stages: the completed block and its spectra while the work is spread out
+        std::vector<float> pendingBlock;
+        std::vector<float> workAccumulator;
+        std::vector<float> workScratch;
+    };
+
+    enum class WorkPhase
+    {
+        transform,
+        multiply,
+        inverse
+    };
+
+    /** Progress through one completed block of a deferred stage. */
+    struct StageWork
+    {
+        bool pending = false;
+        WorkPhase phase = WorkPhase::transform;
+        int numChannels = 0;
+        int channel = 0;
+        int kernel = 0;
+        int partition = 0;
+        int segment = 0;          // history slot that receives the block's spectrum
+        int ringPosition = 0;     // ring position when the block completed
+        int elapsedSamples = 0;
+        int costTotal = 0;
+        int costDone = 0;
+        std::vector<float> weights;
+    };
+
+    enum JobState
+    {
+        jobFree,
+        jobQueued,
+        jobRunning,
+        jobDone,
+        jobAbandoned   // the audio thread gave up on it; the worker frees it when finished
+    };
+
+    /** One completed tail block on its way through the worker. */
+    struct BackgroundJob
+    {
+        std::atomic<int> state{ jobFree };
+        std::atomic<juce::uint32> sequence{ 0 };
+        int numChannels = 0;
+        int ringPosition = 0;
+        std::vector<float> input;             // [channel][partitionSize]
+        std::vector<float> output;            // [channel][fftSize]
+        std::vector<float> weights;
+        std::vector<const Kernel*> kernels;
+    };
+
+    static constexpr int kNumBackgroundJobs = 4;
+
+    /** Hand-off state for a stage run by the worker; history and scratch then belong to the worker. */
+    struct BackgroundState
+    {
+        std::array<BackgroundJob, kNumBackgroundJobs> jobs;
+        std::unique_ptr<juce::dsp::FFT> fft;           // worker
+        std::atomic<juce::uint32> nextSequence{ 0 };   // written by the audio thread
+        std::atomic<bool> resetPending{ false };
+        int outstandingJob = -1;                       // audio thread
+        int outstandingElapsed = 0;                    // audio thread
+        juce::uint32 lastSequence = 0;                 // worker
+        bool hasLastSequence = false;                  // worker
+    };
+
+    /** Runs queued background jobs until the convolver stops it. */
+    class BackgroundWorker : public juce::Thread
+    {
+    public:
+        explicit BackgroundWorker(PartitionedConvolver& ownerConvolver);
+        ~BackgroundWorker() override;
+        void run() override;
+
+    private:
+        PartitionedConvolver& owner;
+    };
+
+    /**
+     * A run of equal-sized partitions starting 'offset' samples into the IR.
+     * Immediate stages recompute the current block on every call (zero latency
+     * from offset 0); deferred stages only run once a block is complete, which
+     * is early enough because offset >= partitionSize. Whatever slack remains
+     * (offset - partitionSize, up to one partition) is the workBudget over which
+     * that block's work is spread.
+     */
+    struct Stage
+    {
+        int partitionSize = 0;
+        int fftSize = 0;
+        int numBins = 0;
+        int spectrumSize = 0;
+        int offset = 0;
+        int maxPartitions = 0;
+        bool immediate = false;
+
+        std::unique_ptr<juce::dsp::FFT> fft;            // audio thread only
+        std::vector<ChannelState> channels;
+
+        int inputPosition = 0;
+        int currentSegment = 0;
+        int ringSize = 0;
+        int ringPosition = 0;
+
+        int workBudget = 0;
+        StageWork work;
+
+        double transformCost = 0.0;     // ms per forward + inverse transform
+        double multiplyCost = 0.0;      // ms per partition multiply-accumulate
+
+        std::unique_ptr<BackgroundState> background;
+    };
+
+    //==============================================================================
+    Layout layout = Layout::uniform;
+    int partitionSize = 0;
+    int numChannels = 0;
+    int preparedIRLength = 0;
+    int headLength = 0;                           // direct-form taps in front of the FFT partitions
+    int headWritePosition = 0;
+    int activeChannels = 0;                       // channels processed by the last call
+    int calibratedBlockSize = 0;
+    double directCostPerTap = 0.0;                // ms per tap and sample
+
+    std::vector<Stage> stages;
+    std::vector<const Kernel*> kernels;
+
+    std::vector<float> headTaps;                  // [channel][kMaxDirectFIRLength], weighted sum of the kernel heads
+    std::vector<float> headHistory;               // [channel][kMaxDirectFIRLength - 1 + kHeadHistoryBlock]
+
+    std::vector<float> kernelTails;               // [kernel][channel][spectrum], immediate stage partitions 1..n
+    std::vector<juce::uint32> kernelTailStamps;   // block in which each tail was accumulated
+    std::vector<float> accumulator;
+    std::vector<float> slotScratch;
+    juce::uint32 blockCounter = 0;
+
+    bool useBackgroundThread = false;
+    std::atomic<int> missedDeadlines{ 0 };
+    std::atomic<bool> waitForLateJobs{ false };
+
+    static constexpr int kHeadLength = 64;              // direct-form taps ahead of the first FFT partition
+    static constexpr int kHeadChunk = 256;
+    static constexpr int kHeadHistoryBlock = 4096;      // input kept ahead of the FIR history before it slides back
+    static constexpr int kMaxDirectFIRLength = 2048;
+    static constexpr int kMaxNonUniformPartition = 8192;
+    static constexpr int kTransformCost = 4;            // an FFT costs roughly four partition multiply-adds
+    static constexpr int kMinBackgroundPartition = 1024;
+
+    //==============================================================================
+    void buildStages(int maxIRLength);
+    void configureBackgroundStages();
+    void calibratePathCosts(int maximumBlockSize);
+    double estimateFFTCost(int irLength) const noexcept;
+    bool shouldUseDirectFIR(int irLength) const noexcept;
+    bool canRun(const Kernel& kernel) const noexcept;
+    std::unique_ptr<Kernel> buildKernel(const juce::AudioBuffer<float>& impulseResponse, Path path) const;
+    void startBackgroundThreadIfNeeded();
+    void processHead(const float* const* input, float* const* output,
+                     int numChannelsToProcess, int numSamples, const float* kernelWeights) noexcept;
+    void processImmediateStage(Stage& stage, const float* const* input, float* const* output,
+                               int numChannelsToProcess, int numSamples, const float* kernelWeights) noexcept;
+    void processDeferredStage(int stageIndex, const float* const* input, float* const* output,
+                              int numChannelsToProcess, int numSamples, const float* kernelWeights) noexcept;
+    void beginStageWork(int stageIndex, int numChannelsToProcess, const float* kernelWeights) noexcept;
+    void advanceStageWork(int stageIndex, int numSamples) noexcept;
+    void finishStageWork(int stageIndex) noexcept;
+    int runWorkUnit(int stageIndex) noexcept;
+    bool kernelHasStageWork(const StageWork& work, int stageIndex, int kernelIndex) const noexcept;
+
+    void pushBackgroundJob(int stageIndex, int numChannelsToProcess, const float* kernelWeights) noexcept;
+    void collectBackgroundJob(int stageIndex) noexcept;
+    void cancelBackgroundJobs(Stage& stage) noexcept;
+    bool runBackgroundJobs() noexcept;
+    void processBackgroundJob(int stageIndex, BackgroundJob& job) noexcept;
+    int getSegmentForSequence(const Stage& stage, juce::uint32 sequence) const noexcept;
+
+    void mirrorHistorySegment(Stage& stage, int sourceChannel, int segment) noexcept;
+    void mirrorChannelState(int numSourceChannels, int numChannelsToProcess) noexcept;
+
+    // The FFT is passed in so each thread uses its own instance: the stage's on the audio
+    // thread, the worker's for background stages, a private one while building kernels
+    void forwardTransform(const Stage& stage, const juce::dsp::FFT& fft, const float* timeDomain,
+                          float* spectrum, float* scratch) const noexcept;
+    void inverseTransform(const Stage& stage, const juce::dsp::FFT& fft,
+                          const float* spectrum, float* scratch) const noexcept;
+    static int getFFTOrder(int fftSize) noexcept;
+    static void multiplyAccumulate(int numBins, const float* input, const float* impulse, float* output) noexcept;
+    void accumulateTail(int kernelIndex, int channel) noexcept;
+
+    // Declared last so it stops before anything it touches is destroyed
+    BackgroundWorker backgroundWorker{ *this };
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolver)
+};
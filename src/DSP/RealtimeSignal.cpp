@@ -0,0 +1,104 @@
+#include "RealtimeSignal.h"
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <cerrno>
+ #include <ctime>
+ #include <semaphore.h>
+#endif
+
+//==============================================================================
+// The OS semaphore behind the signal; it never counts past one, see signal()
+struct RealtimeSignal::Pimpl
+{
+#if JUCE_WINDOWS
+    Pimpl() : semaphore(CreateSemaphoreW(nullptr, 0, 1, nullptr)) { jassert(semaphore != nullptr); }
+    ~Pimpl() { CloseHandle(semaphore); }
+
+    void post() noexcept { ReleaseSemaphore(semaphore, 1, nullptr); }
+
+    bool wait(int timeoutMs) noexcept
+    {
+        return WaitForSingleObject(semaphore, timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs)) == WAIT_OBJECT_0;
+    }
+
+    HANDLE semaphore;
+#elif JUCE_MAC || JUCE_IOS
+    Pimpl() : semaphore(dispatch_semaphore_create(0)) {}
+    ~Pimpl() { dispatch_release(semaphore); }
+
+    void post() noexcept { dispatch_semaphore_signal(semaphore); }
+
+    bool wait(int timeoutMs) noexcept
+    {
+        const auto timeout = timeoutMs < 0 ? DISPATCH_TIME_FOREVER
+                                           : dispatch_time(DISPATCH_TIME_NOW, static_cast<int64_t>(timeoutMs) * 1000000);
+        return dispatch_semaphore_wait(semaphore, timeout) == 0;
+    }
+
+    dispatch_semaphore_t semaphore;
+#else
+    Pimpl() { sem_init(&semaphore, 0, 0); }
+    ~Pimpl() { sem_destroy(&semaphore); }
+
+    void post() noexcept { sem_post(&semaphore); }
+
+    bool wait(int timeoutMs) noexcept
+    {
+        if (timeoutMs < 0)
+        {
+            while (sem_wait(&semaphore) != 0)
+                if (errno != EINTR)
+                    return false;
+
+            return true;
+        }
+
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeoutMs / 1000;
+        deadline.tv_nsec += static_cast<long>(timeoutMs % 1000) * 1000000;
+
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            ++deadline.tv_sec;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        while (sem_timedwait(&semaphore, &deadline) != 0)
+            if (errno != EINTR)
+                return false;
+
+        return true;
+    }
+
+    sem_t semaphore;
+#endif
+};
+
+//==============================================================================
+RealtimeSignal::RealtimeSignal() : pimpl(std::make_unique<Pimpl>())
+{
+}
+
+RealtimeSignal::~RealtimeSignal() = default;
+
+void RealtimeSignal::signal() noexcept
+{
+    // Only the signal that finds nothing pending posts, so a burst costs one semaphore post
+    if (!pending.exchange(true, std::memory_order_acq_rel))
+        pimpl->post();
+}
+
+bool RealtimeSignal::wait(int timeoutMs) noexcept
+{
+    if (!pimpl->wait(timeoutMs))
+        return false;
+
+    // Signals that arrive from here on post again; those before this are served by this wake-up
+    pending.exchange(false, std::memory_order_acq_rel);
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+/**
+ * Wakes one background thread from any thread, including the audio thread.
+ *
+ * Features:
+ * - signal() never locks or allocates: it posts an OS semaphore, and only when the
+ *   waiter doesn't already have a wake-up pending
+ * - Signals coalesce, so a burst of them costs the waiter one wake-up
+ * - Anything published before signal() is visible to the waiter once wait() returns
+ *
+ * juce::WaitableEvent::signal() takes a mutex, which the audio thread must not do.
+ */
+class RealtimeSignal
+{
+public:
+    //==============================================================================
+    RealtimeSignal();
+    ~RealtimeSignal();
+
+    /** Any thread. */
+    void signal() noexcept;
+
+    /**
+     * Blocks until signal() has been called since the last wake-up, or the timeout (in ms,
+     * -1 for none) runs out. Returns true if it was signalled. One waiting thread only.
+     */
+    bool wait(int timeoutMs = -1) noexcept;
+
+private:
+    //==============================================================================
+    struct Pimpl;
+    std::unique_ptr<Pimpl> pimpl;
+    std::atomic<bool> pending{ false };
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeSignal)
+};
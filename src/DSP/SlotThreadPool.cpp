@@ -0,0 +1,192 @@
+#include "SlotThreadPool.h"
+#include <bit>
+#include <thread>
+
+//==============================================================================
+SlotThreadPool::SlotThreadPool(int maxTasksPerBatch, Task taskToRun)
+    : task(std::move(taskToRun))
+{
+    // One bit per task argument in the claim word
+    jassert(maxTasksPerBatch > 0 && maxTasksPerBatch <= 32);
+    maxTasksPerBatch = juce::jlimit(1, 32, maxTasksPerBatch);
+    allTasks = maxTasksPerBatch == 32 ? ~0u : (1u << maxTasksPerBatch) - 1u;
+}
+
+SlotThreadPool::~SlotThreadPool()
+{
+    stop();
+}
+
+//==============================================================================
+void SlotThreadPool::start(int numWorkersToUse, int blockSize, double sampleRate)
+{
+    const juce::ScopedLock lock(startLock);
+
+    if (numWorkers.load() == numWorkersToUse && workerBlockSize == blockSize
+        && juce::approximatelyEqual(workerSampleRate, sampleRate))
+        return;
+
+    // The new workers are up and running before they replace the old ones, so batches keep
+    // using the old workers (or run on the audio thread alone) while the threads start
+    std::vector<std::unique_ptr<Worker>> newWorkers;
+
+    // Workers run inside the audio callback's deadline, so they get the same realtime treatment
+    const auto options = juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime(blockSize, sampleRate);
+
+    for (int i = 0; i < numWorkersToUse; ++i)
+    {
+        newWorkers.push_back(std::make_unique<Worker>(*this));
+
+        // Without realtime scheduling rights (e.g. Linux without rtprio) a high priority is the next
+        // best thing; if such a worker is preempted mid-task, run() stops waiting for it after a block
+        if (!newWorkers.back()->startRealtimeThread(options))
+            newWorkers.back()->startThread(juce::Thread::Priority::high);
+    }
+
+    std::vector<std::unique_ptr<Worker>> oldWorkers;
+    {
+        const juce::SpinLock::ScopedLockType swapLock(workerLock);
+        oldWorkers = std::move(workers);
+        workers = std::move(newWorkers);
+        maxWaitMs.store(blockSize * 1000.0 / juce::jmax(1.0, sampleRate));
+        numWorkers.store(numWorkersToUse);
+    }
+
+    stopWorkers(oldWorkers);
+
+    workerBlockSize = blockSize;
+    workerSampleRate = sampleRate;
+}
+
+void SlotThreadPool::stop()
+{
+    const juce::ScopedLock lock(startLock);
+
+    std::vector<std::unique_ptr<Worker>> oldWorkers;
+    {
+        const juce::SpinLock::ScopedLockType swapLock(workerLock);
+        oldWorkers = std::move(workers);
+        workers.clear();
+        numWorkers.store(0);
+    }
+
+    stopWorkers(oldWorkers);
+
+    workerBlockSize = 0;
+    workerSampleRate = 0.0;
+}
+
+void SlotThreadPool::stopWorkers(std::vector<std::unique_ptr<Worker>>& workersToStop)
+{
+    // All of them are told first, so they wind down together; each one finishes the task it is
+    // running (a batch may still be waiting for it) before its destructor returns
+    for (auto& worker : workersToStop)
+    {
+        worker->signalThreadShouldExit();
+        worker->wakeUp.signal();
+    }
+
+    workersToStop.clear();
+}
+
+void SlotThreadPool::waitForRunningTasks() const
+{
+    while (runningTasks.load(std::memory_order_acquire) != 0)
+        juce::Thread::sleep(1);
+}
+
+//==============================================================================
+juce::uint32 SlotThreadPool::run(juce::uint32 taskMask) noexcept
+{
+    jassert((taskMask & ~allTasks) == 0);
+    taskMask &= allTasks;
+
+    // A task a worker is still running from an earlier batch owns its argument until it finishes
+    const auto stillRunning = runningTasks.load(std::memory_order_acquire) & taskMask;
+    const auto batch = taskMask & ~stillRunning;
+
+    if (batch == 0)
+        return stillRunning;
+
+    runningTasks.fetch_or(batch, std::memory_order_relaxed);
+    claim.store((static_cast<juce::uint64>(++batchNumber) << 32) | batch, std::memory_order_release);
+
+    // Only as many wake-ups as there is work for other threads; if start() or stop() is swapping
+    // the workers right now, nobody is woken and the loop below runs the whole batch
+    {
+        const juce::SpinLock::ScopedTryLockType lock(workerLock);
+        if (lock.isLocked())
+        {
+            const auto numToWake = juce::jmin(static_cast<int>(workers.size()), std::popcount(batch) - 1);
+            for (int i = 0; i < numToWake; ++i)
+                workers[static_cast<size_t>(i)]->wakeUp.signal();
+        }
+    }
+
+    // Every task nobody has claimed yet is run here, so what is left is already running elsewhere
+    runTasks();
+
+    if ((runningTasks.load(std::memory_order_acquire) & batch) != 0)
+    {
+        // A worker that was preempted mid-task could otherwise hold up the callback indefinitely
+        const auto deadline = juce::Time::getMillisecondCounterHiRes() + maxWaitMs.load();
+
+        while ((runningTasks.load(std::memory_order_acquire) & batch) != 0)
+        {
+            if (juce::Time::getMillisecondCounterHiRes() > deadline)
+            {
+                missedDeadlines.fetch_add(1);
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    return stillRunning | (runningTasks.load(std::memory_order_acquire) & batch);
+}
+
+void SlotThreadPool::runTasks() noexcept
+{
+    for (;;)
+    {
+        auto current = claim.load(std::memory_order_acquire);
+        const auto unclaimed = static_cast<juce::uint32>(current & 0xffffffffu);
+
+        if (unclaimed == 0)
+            return;
+
+        // The argument is the claimed bit itself, so nothing else has to be read after the claim
+        const auto argument = std::countr_zero(unclaimed);
+        if (!claim.compare_exchange_weak(current, current & ~(static_cast<juce::uint64>(1) << argument),
+                                         std::memory_order_acq_rel))
+            continue;
+
+        task(argument);
+        runningTasks.fetch_and(~(1u << argument), std::memory_order_release);
+    }
+}
+
+//==============================================================================
+SlotThreadPool::Worker::Worker(SlotThreadPool& ownerPool)
+    : juce::Thread("KingsCab Slot Worker"), owner(ownerPool)
+{
+}
+
+SlotThreadPool::Worker::~Worker()
+{
+    // Never killed: a task in progress always runs to the end
+    signalThreadShouldExit();
+    wakeUp.signal();
+    waitForThreadToExit(-1);
+}
+
+void SlotThreadPool::Worker::run()
+{
+    // Sleeps until run() has work for it; the audio thread's wake-up never takes a lock
+    while (!threadShouldExit())
+    {
+        owner.runTasks();
+        wakeUp.wait();
+    }
+}
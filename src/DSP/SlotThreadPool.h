@@ -0,0 +1,102 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "RealtimeSignal.h"
+
+//==============================================================================
+/**
+ * Small work-stealing pool for running independent slot convolutions in parallel.
+ *
+ * Features:
+ * - The calling (audio) thread takes part in every batch, so a batch never waits for a
+ *   worker to wake up: whatever nobody has claimed yet is run by the next free thread
+ * - Tasks are claimed from one atomic word, so threads that finish early keep taking
+ *   work the busy ones haven't started
+ * - Running a batch never allocates or locks; the caller only waits for tasks already in
+ *   progress, and for at most one block period. A task still running after that is left
+ *   to finish and reported, and its argument is skipped by later batches until it has
+ * - Workers only exist between start() and stop(), so an unused pool costs nothing, and they
+ *   are never stopped in the middle of a task
+ * - Workers are realtime threads with the audio block period, so the OS schedules them like
+ *   the audio thread they are helping
+ *
+ * The task function is fixed at construction; a batch is a bitmask of task arguments, so at
+ * most 32 distinct arguments (0 to 31) can be used.
+ */
+class SlotThreadPool
+{
+public:
+    //==============================================================================
+    using Task = std::function<void(int)>;
+
+    SlotThreadPool(int maxTasksPerBatch, Task taskToRun);
+    ~SlotThreadPool();
+
+    //==============================================================================
+    // Any time, from a non-audio thread: new workers are started before they replace the old
+    // ones, and the old ones finish their tasks before they stop. start() only restarts workers
+    // if something changed.
+    void start(int numWorkersToUse, int blockSize, double sampleRate);
+    void stop();
+    int getNumWorkers() const noexcept { return numWorkers.load(); }
+
+    /**
+     * Runs task(i) for every bit i set in taskMask, and returns the tasks that didn't finish:
+     * any a worker was still running when the wait ran out, and any left out because a
+     * worker was still running them from an earlier batch.
+     */
+    juce::uint32 run(juce::uint32 taskMask) noexcept;
+
+    /** Tasks a worker is still running from a batch that has already returned. */
+    juce::uint32 getRunningTasks() const noexcept { return runningTasks.load(std::memory_order_acquire); }
+
+    /** Blocks until no task is running. Never call on the audio thread. */
+    void waitForRunningTasks() const;
+
+    /** Batches that returned before a worker had finished its task. */
+    int getNumMissedDeadlines() const noexcept { return missedDeadlines.load(); }
+
+private:
+    //==============================================================================
+    class Worker : public juce::Thread
+    {
+    public:
+        explicit Worker(SlotThreadPool& ownerPool);
+        ~Worker() override;   // waits for the task in progress, if any
+        void run() override;
+
+        RealtimeSignal wakeUp;
+
+    private:
+        SlotThreadPool& owner;
+    };
+
+    //==============================================================================
+    Task task;
+    juce::uint32 allTasks = 0;
+    std::vector<std::unique_ptr<Worker>> workers;   // swapped under workerLock
+    std::atomic<int> numWorkers{ 0 };
+    juce::SpinLock workerLock;        // held by start()/stop() only to swap the worker list in or out
+    juce::CriticalSection startLock;  // start() against stop(); never taken by the audio thread
+    int workerBlockSize = 0;          // guarded by startLock: the block period the workers were started with
+    double workerSampleRate = 0.0;
+    std::atomic<double> maxWaitMs{ 0.0 };   // one block period
+
+    // Batch number and the arguments nobody has claimed yet, packed together, so a worker that
+    // wakes up late can never claim a task from the following batch
+    std::atomic<juce::uint64> claim{ 0 };
+    std::atomic<juce::uint32> runningTasks{ 0 };   // claimed or waiting to be, and not finished
+    std::atomic<int> missedDeadlines{ 0 };
+    juce::uint32 batchNumber = 0;
+
+    //==============================================================================
+    void runTasks() noexcept;
+    static void stopWorkers(std::vector<std::unique_ptr<Worker>>& workersToStop);
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SlotThreadPool)
+};
@@ -15,12 +15,22 @@ TheKingsCabAudioProcessorEditor::TheKingsCabAudioProcessorEditor(TheKingsCabAudi
     // Initialize IR folder data
     initializeIRData();
     
+    // Slot displays follow the background loader as IRs finish loading, and the folder
+    // lists follow the library scan
+    audioProcessor.getIRLoader().addListener(this);
+    audioProcessor.getIRManager().addListener(this);
+
+    // The slots' own folders were requested above; read the rest while the UI is idle
+    audioProcessor.getIRManager().prefetchFolders();
+    
     // Start timer for UI updates
     startTimerHz(30); // 30 FPS for smooth UI updates
 }
 
 TheKingsCabAudioProcessorEditor::~TheKingsCabAudioProcessorEditor()
 {
+    audioProcessor.getIRManager().removeListener(this);
+    audioProcessor.getIRLoader().removeListener(this);
     setLookAndFeel(nullptr);
 }
 
@@ -112,6 +122,10 @@ void TheKingsCabAudioProcessorEditor::setupIRSlots()
         irSlots[i]->onIRCleared = [this](int slotIndex) {
             onIRCleared(slotIndex);
         };
+
+        irSlots[i]->onFolderNeeded = [this](const juce::File& directory) {
+            audioProcessor.getIRManager().requestFolder(directory);
+        };
         
         addAndMakeVisible(*irSlots[i]);
     }
@@ -219,6 +233,12 @@ void TheKingsCabAudioProcessorEditor::resized()
 //==============================================================================
 void TheKingsCabAudioProcessorEditor::timerCallback()
 {
+    if (irFoldersNeedUpdate)
+    {
+        irFoldersNeedUpdate = false;
+        initializeIRData();
+    }
+
     updateStatusDisplay();
     
     // IR slots will get folder data directly from IRManager
@@ -245,6 +265,10 @@ void TheKingsCabAudioProcessorEditor::updateStatusDisplay()
     
     juce::String status = juce::String(loadedCount) + "/" + 
                          juce::String(TheKingsCabAudioProcessor::kNumIRSlots) + " IRs loaded";
+
+    if (audioProcessor.hasOfflineLoadTimedOut())
+        status += " - offline render started before all IRs loaded";
+
     statusLabel->setText(status, juce::dontSendNotification);
 }
 
@@ -614,15 +638,36 @@ void TheKingsCabAudioProcessorEditor::drawFooter(juce::Graphics& g, const juce::
 //==============================================================================
 void TheKingsCabAudioProcessorEditor::onIRSelected(int slotIndex, const juce::File& irFile)
 {
-    // Load IR into the audio processor
+    // Queue the IR with the audio processor; the slot display updates in irLoadFinished()
+    // once the latest selection has actually loaded
     audioProcessor.loadImpulseResponse(slotIndex, irFile);
-    
-    // Update slot visual state
-    if (slotIndex >= 0 && slotIndex < TheKingsCabAudioProcessor::kNumIRSlots)
+}
+
+void TheKingsCabAudioProcessorEditor::irLoadFinished(int slotIndex, const juce::File& irFile, bool success)
+{
+    if (slotIndex < 0 || slotIndex >= TheKingsCabAudioProcessor::kNumIRSlots || irSlots[slotIndex] == nullptr)
+        return;
+
+    // Clears are already reflected by the slot itself
+    if (irFile == juce::File())
+        return;
+
+    if (success)
     {
-        auto irInfo = IRManager::getIRInfo(irFile);
+        IRManager::IRInfo irInfo(irFile);
         irSlots[slotIndex]->setLoadedIR(irInfo.folder, irInfo.name);
     }
+    else
+    {
+        DBG("Editor: IR failed to load for slot " << slotIndex << ": " << irFile.getFullPathName());
+        irSlots[slotIndex]->setActive(audioProcessor.getIRManager().isIRLoaded(slotIndex));
+    }
+}
+
+void TheKingsCabAudioProcessorEditor::irFoldersChanged()
+{
+    // A scan publishes folders one after another; the timer picks them up together
+    irFoldersNeedUpdate = true;
 }
 
 void TheKingsCabAudioProcessorEditor::onIRCleared(int slotIndex)
@@ -645,7 +690,13 @@ void TheKingsCabAudioProcessorEditor::initializeIRData()
         if (irSlots[i])
         {
             irSlots[i]->updateFolderList(folders);
-            auto loadedFile = audioProcessor.getIRManager().getLoadedIR(i);
+
+            // Runs again whenever the scan publishes folders: a slot the user is already
+            // browsing keeps its folder, the others pick up their IR's folder once it arrives
+            if (irSlots[i]->hasFolderSelected())
+                continue;
+
+            auto loadedFile = audioProcessor.getIRLoader().getRequestedIR(i); // includes restores still loading
             if (loadedFile.existsAsFile())
             {
                 irSlots[i]->syncToLoadedFile(loadedFile);
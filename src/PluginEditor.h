@@ -18,7 +18,9 @@
  */
 class TheKingsCabAudioProcessorEditor : public juce::AudioProcessorEditor,
                                         public juce::Timer,
-                                        public juce::Slider::Listener
+                                        public juce::Slider::Listener,
+                                        public IRLoader::Listener,
+                                        public IRManager::Listener
 {
 public:
     //==============================================================================
@@ -37,6 +39,13 @@ public:
     // Slider listener for master controls
     void sliderValueChanged(juce::Slider* slider) override;
 
+    //==============================================================================
+    // Background IR loader completion (message thread)
+    void irLoadFinished(int slotIndex, const juce::File& irFile, bool success) override;
+
+    // Library scan progress (message thread): folders appear as they finish scanning
+    void irFoldersChanged() override;
+
 private:
     //==============================================================================
     // Reference to processor
@@ -72,6 +81,9 @@ private:
     std::unique_ptr<juce::Label> statusLabel;
     std::unique_ptr<juce::HyperlinkButton> storeLink;
 
+    // Set by irFoldersChanged(), handled (once per burst of folders) by the timer
+    bool irFoldersNeedUpdate = false;
+
     //==============================================================================
     // Parameter attachments
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> masterGainAttachment;
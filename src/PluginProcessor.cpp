@@ -1,5 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeAllocationChecker.h"
 
 //==============================================================================
 TheKingsCabAudioProcessor::TheKingsCabAudioProcessor()
@@ -17,6 +18,13 @@ TheKingsCabAudioProcessor::TheKingsCabAudioProcessor()
       convolutionEngine(kNumIRSlots, kMaxIRLength),
       irManager()
 {
+    resolveParameterValues();
+    irLoader.addListener(this);
+
+    // Per-slot convolution unless the session picks one of the shared modes
+    valueTreeState.addParameterListener("processing_mode", this);
+    applyProcessingMode();
+
     // Initialize IR manager with King Studios exclusive IR collection
     // Try multiple common install/test locations so Standalone and DAWs find IRs without user setup
     {
@@ -73,6 +81,9 @@ TheKingsCabAudioProcessor::TheKingsCabAudioProcessor()
 
 TheKingsCabAudioProcessor::~TheKingsCabAudioProcessor()
 {
+    valueTreeState.removeParameterListener("processing_mode", this);
+    cancelPendingUpdate();
+    irLoader.removeListener(this);
 }
 
 //==============================================================================
@@ -110,7 +121,12 @@ bool TheKingsCabAudioProcessor::isMidiEffect() const
 
 double TheKingsCabAudioProcessor::getTailLengthSeconds() const
 {
-    return 4.0; // Maximum IR length
+    // The longest loaded IR, so hosts can stop calling us once it has rung out. A restored
+    // session's IRs are still loading, so until they are in, any of them could be the longest
+    if (restoringSlots.load() != 0)
+        return static_cast<double>(kMaxIRLength) / currentSampleRate;
+
+    return convolutionEngine.getTailLengthSeconds();
 }
 
 int TheKingsCabAudioProcessor::getNumPrograms()
@@ -146,6 +162,9 @@ void TheKingsCabAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
     currentSampleRate = sampleRate;
     currentBlockSize = samplesPerBlock;
 
+    // A mode change still queued for the message thread is applied now, so the engine prepares for it
+    applyProcessingMode();
+
     // Prepare the convolution engine with current audio settings
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
@@ -153,6 +172,26 @@ void TheKingsCabAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
     spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
     
     convolutionEngine.prepare(spec);
+
+    // A session loaded for a batch bounce may still be decoding its IRs, so an offline render
+    // waits for every requested IR to be in place before its first block
+    bool loadsTimedOut = false;
+    if (isNonRealtime() && !irLoader.waitUntilIdle(kOfflineLoadTimeoutMs))
+    {
+        DBG("Offline render starting before all IRs loaded (waited " << kOfflineLoadTimeoutMs << " ms)");
+        loadsTimedOut = true;
+    }
+
+    offlineLoadTimedOut.store(loadsTimedOut);
+}
+
+void TheKingsCabAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+
+    // Bounce/freeze trade latency for throughput. Some hosts call this from the audio thread on
+    // every block, so the engine only flags the change and builds the other layout in the background
+    convolutionEngine.setNonRealtime(isNonRealtime);
 }
 
 void TheKingsCabAudioProcessor::releaseResources()
@@ -189,6 +228,10 @@ void TheKingsCabAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     juce::ignoreUnused(midiMessages);
 
     juce::ScopedNoDenormals noDenormals;
+
+    // From here on nothing may allocate, lock or wait (checked by the KingsCabTests app)
+    const RealtimeAllocationChecker::ScopedAudioCallback realtimeScope;
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -198,25 +241,19 @@ void TheKingsCabAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
 
     // Sync realtime parameters to DSP engine (master and per-slot)
     {
-        const float masterGainDb = valueTreeState.getRawParameterValue("master_gain")->load();
-        const float masterGainLin = juce::Decibels::decibelsToGain(masterGainDb, -100.0f);
-        const float masterMixValue  = valueTreeState.getRawParameterValue("master_mix")->load();
-        convolutionEngine.setMasterGain(masterGainLin);
-        convolutionEngine.setMasterMix(masterMixValue);
+        const float masterGainDb = masterGainValue->load();
+        convolutionEngine.setMasterGain(juce::Decibels::decibelsToGain(masterGainDb, -100.0f));
+        convolutionEngine.setMasterMix(masterMixValue->load());
 
         for (int slot = 0; slot < kNumIRSlots; ++slot)
         {
-            const juce::String prefix = "slot" + juce::String(slot) + "_";
-            const float slotGainDb  = valueTreeState.getRawParameterValue(prefix + "gain")->load();
-            const float slotGainLin = juce::Decibels::decibelsToGain(slotGainDb, -100.0f);
-            const float slotMuteF = valueTreeState.getRawParameterValue(prefix + "mute")->load();
-            const float slotSoloF = valueTreeState.getRawParameterValue(prefix + "solo")->load();
-            const float slotPhsF  = valueTreeState.getRawParameterValue(prefix + "phase")->load();
-
-            convolutionEngine.setSlotGain(slot, slotGainLin);
-            convolutionEngine.setSlotMute(slot, slotMuteF > 0.5f);
-            convolutionEngine.setSlotSolo(slot, slotSoloF > 0.5f);
-            convolutionEngine.setSlotPhaseInvert(slot, slotPhsF > 0.5f);
+            const auto& values = slotParameterValues[static_cast<size_t>(slot)];
+            const float slotGainDb = values.gain->load();
+
+            convolutionEngine.setSlotGain(slot, juce::Decibels::decibelsToGain(slotGainDb, -100.0f));
+            convolutionEngine.setSlotMute(slot, values.mute->load() > 0.5f);
+            convolutionEngine.setSlotSolo(slot, values.solo->load() > 0.5f);
+            convolutionEngine.setSlotPhaseInvert(slot, values.phase->load() > 0.5f);
         }
     }
 
@@ -249,7 +286,8 @@ void TheKingsCabAudioProcessor::getStateInformation (juce::MemoryBlock& destData
     auto irState = juce::ValueTree("IRFiles");
     for (int i = 0; i < kNumIRSlots; ++i)
     {
-        auto irFile = irManager.getLoadedIR(i);
+        // Includes loads still in flight, so a save right after a selection keeps it
+        auto irFile = irLoader.getRequestedIR(i);
         if (irFile.existsAsFile())
         {
             auto irSlot = juce::ValueTree("Slot" + juce::String(i));
@@ -289,6 +327,7 @@ void TheKingsCabAudioProcessor::setStateInformation (const void* data, int sizeI
                         {
                             juce::File irFile(path);
                             // Attempt to load IR regardless; if missing, slot stays empty gracefully
+                            restoringSlots.fetch_or(1u << i);
                             loadImpulseResponse(i, irFile);
                         }
                     }
@@ -301,70 +340,40 @@ void TheKingsCabAudioProcessor::setStateInformation (const void* data, int sizeI
 //==============================================================================
 void TheKingsCabAudioProcessor::loadImpulseResponse(int slotIndex, const juce::File& irFile)
 {
-    DBG("=== AUDIO PROCESSOR loadImpulseResponse START ===");
-    DBG("Loading IR for slot " << slotIndex << ": " << irFile.getFullPathName());
+    DBG("Requesting IR for slot " << slotIndex << ": " << irFile.getFullPathName());
     
     if (slotIndex >= 0 && slotIndex < kNumIRSlots)
     {
-        DBG("Slot index valid, calling IRManager.loadIR...");
-        
-        // Load IR through manager and update convolution engine
-        if (irManager.loadIR(slotIndex, irFile))
-        {
-            DBG("IRManager.loadIR returned SUCCESS, getting buffer...");
-            auto irBuffer = irManager.getIRBuffer(slotIndex);
-            if (irBuffer != nullptr)
-            {
-                DBG("IR buffer obtained, loading into convolution engine...");
-                bool convolutionSuccess = convolutionEngine.loadImpulseResponse(slotIndex, *irBuffer);
-                DBG("Convolution engine loadImpulseResponse result: " << (convolutionSuccess ? "SUCCESS" : "FAILED"));
-                
-                if (convolutionSuccess)
-                {
-                    // Force immediate audio processing update
-                    DBG("Forcing immediate audio processing sync...");
-                    
-                    // Trigger a parameter update to force audio engine refresh
-                    auto* gainParam = valueTreeState.getParameter("slot" + juce::String(slotIndex) + "_gain");
-                    if (gainParam)
-                    {
-                        // Briefly modify and restore gain (in dB) to force processing update
-                        float currentGain = gainParam->getValue();
-                        gainParam->setValueNotifyingHost(currentGain + 0.1f);
-                        gainParam->setValueNotifyingHost(currentGain);
-                        DBG("Forced parameter refresh completed");
-                    }
-                    else
-                    {
-                        // As a fallback, reset the engine smoothers immediately
-                        convolutionEngine.setSlotGain(slotIndex, 1.0f);
-                    }
-                }
-            }
-            else
-            {
-                DBG("ERROR: IR buffer is null after successful IRManager.loadIR!");
-            }
-        }
-        else
-        {
-            DBG("ERROR: IRManager.loadIR returned FAILURE for slot " << slotIndex);
-        }
+        // Decode, trim and convolution preparation all run on the loader thread; the engine
+        // crossfades to the new IR as soon as it is ready
+        irLoader.requestLoad(slotIndex, irFile);
     }
     else
     {
         DBG("ERROR: Invalid slot index " << slotIndex << " (must be 0-" << (kNumIRSlots-1) << ")");
     }
-    
-    DBG("=== AUDIO PROCESSOR loadImpulseResponse END ===");
 }
 
 void TheKingsCabAudioProcessor::clearImpulseResponse(int slotIndex)
 {
+    // Queued behind any load still in flight for the slot, so it can't be resurrected
     if (slotIndex >= 0 && slotIndex < kNumIRSlots)
+        irLoader.requestClear(slotIndex);
+}
+
+void TheKingsCabAudioProcessor::irLoadFinished(int slotIndex, const juce::File& irFile, bool success)
+{
+    juce::ignoreUnused(irFile, success);
+
+    // Only a slot's latest request reports, so a restore that was superseded is done too
+    restoringSlots.fetch_and(~(1u << slotIndex));
+
+    const auto tailSeconds = getTailLengthSeconds();
+    if (tailSeconds != reportedTailSeconds)
     {
-        irManager.clearIR(slotIndex);
-        convolutionEngine.clearImpulseResponse(slotIndex);
+        DBG("Tail length now " << tailSeconds << " s");
+        reportedTailSeconds = tailSeconds;
+        updateHostDisplay(ChangeDetails().withLatencyChanged(false));
     }
 }
 
@@ -385,6 +394,13 @@ juce::AudioProcessorValueTreeState::ParameterLayout TheKingsCabAudioProcessor::c
         "master_mix", "Dry/IR Mix", 
         juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 1.0f));
 
+    // Engine processing mode, in ConvolutionEngine::ProcessingMode order. Not automatable:
+    // switching moves every slot to another convolution path
+    parameters.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "processing_mode", "Processing Mode",
+        juce::StringArray{ "Per Slot", "Shared Spectrum", "Zero Latency" }, 0,
+        juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+
     // IR slot parameters
     for (int i = 0; i < kNumIRSlots; ++i)
     {
@@ -411,6 +427,53 @@ juce::AudioProcessorValueTreeState::ParameterLayout TheKingsCabAudioProcessor::c
     return { parameters.begin(), parameters.end() };
 }
 
+void TheKingsCabAudioProcessor::resolveParameterValues()
+{
+    masterGainValue = valueTreeState.getRawParameterValue("master_gain");
+    masterMixValue = valueTreeState.getRawParameterValue("master_mix");
+    processingModeValue = valueTreeState.getRawParameterValue("processing_mode");
+    jassert(masterGainValue != nullptr && masterMixValue != nullptr && processingModeValue != nullptr);
+
+    for (int slot = 0; slot < kNumIRSlots; ++slot)
+    {
+        const auto prefix = "slot" + juce::String(slot) + "_";
+        auto& values = slotParameterValues[static_cast<size_t>(slot)];
+
+        values.gain = valueTreeState.getRawParameterValue(prefix + "gain");
+        values.mute = valueTreeState.getRawParameterValue(prefix + "mute");
+        values.solo = valueTreeState.getRawParameterValue(prefix + "solo");
+        values.phase = valueTreeState.getRawParameterValue(prefix + "phase");
+        jassert(values.gain != nullptr && values.mute != nullptr
+                && values.solo != nullptr && values.phase != nullptr);
+    }
+}
+
+void TheKingsCabAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    juce::ignoreUnused(parameterID, newValue);
+
+    // Hosts may set parameters from the audio thread, and a mode change starts or stops the
+    // slot workers, so it is applied on the message thread
+    triggerAsyncUpdate();
+}
+
+void TheKingsCabAudioProcessor::handleAsyncUpdate()
+{
+    applyProcessingMode();
+}
+
+void TheKingsCabAudioProcessor::applyProcessingMode()
+{
+    const auto mode = static_cast<ConvolutionEngine::ProcessingMode>(
+        juce::jlimit(0, 2, juce::roundToInt(processingModeValue->load())));
+
+    if (mode != convolutionEngine.getProcessingMode())
+    {
+        DBG("Processing mode: " << juce::roundToInt(processingModeValue->load()));
+        convolutionEngine.setProcessingMode(mode);
+    }
+}
+
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
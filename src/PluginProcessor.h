@@ -3,6 +3,9 @@
 #include <JuceHeader.h>
 #include "DSP/ConvolutionEngine.h"
 #include "DSP/IRManager.h"
+#include "DSP/IRLoader.h"
+#include <array>
+#include <atomic>
 
 //==============================================================================
 /**
@@ -11,7 +14,10 @@
  * High-performance VST3 plugin for guitar cabinet simulation with 6 IR slots.
  * Optimized for low CPU usage and professional audio quality.
  */
-class TheKingsCabAudioProcessor : public juce::AudioProcessor
+class TheKingsCabAudioProcessor : public juce::AudioProcessor,
+                                  private IRLoader::Listener,
+                                  private juce::AudioProcessorValueTreeState::Listener,
+                                  private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -27,6 +33,7 @@ public:
 #endif
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void setNonRealtime(bool isNonRealtime) noexcept override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -52,11 +59,16 @@ public:
     void setStateInformation(const void* data, int sizeInBytes) override;
 
     //==============================================================================
-    // IR Management
+    // IR Management (asynchronous: requests are coalesced per slot by the background
+    // loader, and completion is reported through IRLoader::Listener)
     void loadImpulseResponse(int slotIndex, const juce::File& irFile);
     void clearImpulseResponse(int slotIndex);
     IRManager& getIRManager() { return irManager; }
+    IRLoader& getIRLoader() { return irLoader; }
     ConvolutionEngine& getConvolutionEngine() { return convolutionEngine; }
+
+    // True when the last offline render started before all of its IRs had loaded
+    bool hasOfflineLoadTimedOut() const { return offlineLoadTimedOut.load(); }
     
     // Parameter access
     juce::AudioProcessorValueTreeState& getValueTreeState() { return valueTreeState; }
@@ -70,15 +82,50 @@ private:
     // Parameter creation helper
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
+    // Looks every realtime parameter up once, so processBlock() never builds an ID string
+    void resolveParameterValues();
+
+    // IRLoader::Listener: the tail follows the loaded IRs, and the host is told when it moves
+    void irLoadFinished(int slotIndex, const juce::File& irFile, bool success) override;
+
+    // The processing mode parameter is applied to the engine on the message thread
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    void applyProcessingMode();
+
     // Core components
     juce::AudioProcessorValueTreeState valueTreeState;
     ConvolutionEngine convolutionEngine;
     IRManager irManager;
+    IRLoader irLoader{ irManager, convolutionEngine, kNumIRSlots }; // declared last: stops before the engine goes
+
+    // Raw parameter values read by processBlock(), indexed by slot (owned by valueTreeState)
+    struct SlotParameterValues
+    {
+        std::atomic<float>* gain = nullptr;
+        std::atomic<float>* mute = nullptr;
+        std::atomic<float>* solo = nullptr;
+        std::atomic<float>* phase = nullptr;
+    };
+
+    std::atomic<float>* masterGainValue = nullptr;
+    std::atomic<float>* masterMixValue = nullptr;
+    std::atomic<float>* processingModeValue = nullptr;
+    std::array<SlotParameterValues, kNumIRSlots> slotParameterValues{};
 
     // Performance monitoring
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
 
+    // Offline renders wait this long in prepareToPlay() for queued IR loads
+    static constexpr int kOfflineLoadTimeoutMs = 10000;
+    std::atomic<bool> offlineLoadTimedOut{ false };
+
+    // Slots restored from a session whose loads haven't finished; until then the tail is the
+    // longest IR we support, so a host never cuts a restored IR's tail short
+    std::atomic<juce::uint32> restoringSlots{ 0 };
+    double reportedTailSeconds = 0.0;     // message thread: the tail the host was last told about
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TheKingsCabAudioProcessor)
 };
\ No newline at end of file
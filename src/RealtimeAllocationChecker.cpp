@@ -0,0 +1,239 @@
+#include "RealtimeAllocationChecker.h"
+
+#if KINGSCAB_CHECK_REALTIME_ALLOCATIONS
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_LINUX && defined(__GLIBC__)
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #define KINGSCAB_CHECK_C_HEAP_AND_LOCKS 1
+
+ // glibc's own allocator, under the replacements below
+ extern "C" void* __libc_malloc(size_t);
+ extern "C" void* __libc_calloc(size_t, size_t);
+ extern "C" void* __libc_realloc(void*, size_t);
+ extern "C" void* __libc_memalign(size_t, size_t);
+ extern "C" void __libc_free(void*);
+#elif JUCE_MAC
+ #include <dlfcn.h>
+ #include <malloc/malloc.h>
+ #include <pthread.h>
+ #define KINGSCAB_CHECK_C_HEAP_AND_LOCKS 1
+#else
+ // Windows (and Linux without glibc): the C runtime's malloc and the OS locks can't be replaced
+ // from the app, so only operator new / delete are checked there
+ #define KINGSCAB_CHECK_C_HEAP_AND_LOCKS 0
+#endif
+
+namespace
+{
+    thread_local bool insideAudioCallback = false;
+    std::atomic<int> numViolations{ 0 };
+
+    void checkRealtimeOperation() noexcept
+    {
+        if (!insideAudioCallback)
+            return;
+
+        // Reporting may allocate or lock itself, so it runs outside the checked scope
+        insideAudioCallback = false;
+        numViolations.fetch_add(1);
+        jassertfalse; // Heap use or a blocking lock on the audio thread: the call stack shows who did it
+        insideAudioCallback = true;
+    }
+
+    //==============================================================================
+    // The allocator underneath the checks, so nothing is counted twice
+#if JUCE_LINUX && KINGSCAB_CHECK_C_HEAP_AND_LOCKS
+    void* systemMalloc(std::size_t size) noexcept                          { return __libc_malloc(size); }
+    void* systemCalloc(std::size_t count, std::size_t size) noexcept       { return __libc_calloc(count, size); }
+    void* systemRealloc(void* pointer, std::size_t size) noexcept          { return __libc_realloc(pointer, size); }
+    void* systemAlignedAlloc(std::size_t alignment, std::size_t size) noexcept { return __libc_memalign(alignment, size); }
+    void systemFree(void* pointer) noexcept                                { __libc_free(pointer); }
+#elif JUCE_MAC
+    void* systemMalloc(std::size_t size) noexcept                          { return malloc_zone_malloc(malloc_default_zone(), size); }
+    void* systemCalloc(std::size_t count, std::size_t size) noexcept       { return malloc_zone_calloc(malloc_default_zone(), count, size); }
+    void* systemAlignedAlloc(std::size_t alignment, std::size_t size) noexcept { return malloc_zone_memalign(malloc_default_zone(), alignment, size); }
+
+    malloc_zone_t* zoneOf(void* pointer) noexcept
+    {
+        // Blocks from other zones (system frameworks may use their own) go back where they came from
+        auto* zone = malloc_zone_from_ptr(pointer);
+        jassert(zone != nullptr);
+        return zone != nullptr ? zone : malloc_default_zone();
+    }
+
+    void* systemRealloc(void* pointer, std::size_t size) noexcept
+    {
+        return pointer == nullptr ? systemMalloc(size) : malloc_zone_realloc(zoneOf(pointer), pointer, size);
+    }
+
+    void systemFree(void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            malloc_zone_free(zoneOf(pointer), pointer);
+    }
+#else
+    void* systemMalloc(std::size_t size) noexcept                          { return std::malloc(size); }
+    void systemFree(void* pointer) noexcept                                { std::free(pointer); }
+#endif
+
+    void* allocate(std::size_t size) noexcept
+    {
+        checkRealtimeOperation();
+        return systemMalloc(size == 0 ? 1 : size);
+    }
+
+    void release(void* pointer) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        checkRealtimeOperation();
+        systemFree(pointer);
+    }
+
+#if KINGSCAB_CHECK_C_HEAP_AND_LOCKS
+    //==============================================================================
+    using MutexLockFunction = int (*)(pthread_mutex_t*);
+    std::atomic<MutexLockFunction> systemMutexLock{ nullptr };
+
+    int lockMutex(pthread_mutex_t* mutex) noexcept
+    {
+        // Looked up on first use: static constructors lock mutexes before this file's have run
+        auto function = systemMutexLock.load(std::memory_order_acquire);
+
+        if (function == nullptr)
+        {
+            function = reinterpret_cast<MutexLockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+            jassert(function != nullptr);
+            systemMutexLock.store(function, std::memory_order_release);
+        }
+
+        return function(mutex);
+    }
+#endif
+}
+
+//==============================================================================
+// Replacements for the global allocation functions (the aligned overloads keep their defaults,
+// which end up in the checked aligned_alloc / posix_memalign below where those are replaced)
+void* operator new(std::size_t size)
+{
+    if (auto* pointer = allocate(size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (auto* pointer = allocate(size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept   { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* pointer) noexcept                           { release(pointer); }
+void operator delete[](void* pointer) noexcept                         { release(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept              { release(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept            { release(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept    { release(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept  { release(pointer); }
+
+#if KINGSCAB_CHECK_C_HEAP_AND_LOCKS
+//==============================================================================
+// Replacements for the C heap (juce::HeapBlock and most C libraries use it) and for the mutex
+// behind juce::CriticalSection, WaitableEvent and std::mutex. Defined in the executable, they
+// take the place of libc's for the whole process on Linux. On macOS the two-level namespace
+// keeps them to code linked into the app itself (JUCE and the plugin's sources): system
+// libraries, libc++'s out-of-line std::mutex among them, still call the originals.
+// Try-locks aren't blocking, so pthread_mutex_trylock and juce::SpinLock stay unchecked.
+extern "C"
+{
+    void* malloc(size_t size)
+    {
+        checkRealtimeOperation();
+        return systemMalloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        checkRealtimeOperation();
+        return systemCalloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size)
+    {
+        checkRealtimeOperation();
+        return systemRealloc(pointer, size);
+    }
+
+    void free(void* pointer)
+    {
+        if (pointer == nullptr)
+            return;
+
+        checkRealtimeOperation();
+        systemFree(pointer);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size)
+    {
+        if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        checkRealtimeOperation();
+        *result = systemAlignedAlloc(alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        checkRealtimeOperation();
+        return systemAlignedAlloc(alignment, size);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        checkRealtimeOperation();
+        return lockMutex(mutex);
+    }
+}
+#endif
+
+//==============================================================================
+RealtimeAllocationChecker::ScopedAudioCallback::ScopedAudioCallback() noexcept
+{
+    insideAudioCallback = true;
+}
+
+RealtimeAllocationChecker::ScopedAudioCallback::~ScopedAudioCallback() noexcept
+{
+    insideAudioCallback = false;
+}
+
+int RealtimeAllocationChecker::getNumViolations() noexcept
+{
+    return numViolations.load();
+}
+
+#else
+
+//==============================================================================
+RealtimeAllocationChecker::ScopedAudioCallback::ScopedAudioCallback() noexcept {}
+RealtimeAllocationChecker::ScopedAudioCallback::~ScopedAudioCallback() noexcept {}
+
+int RealtimeAllocationChecker::getNumViolations() noexcept
+{
+    return 0;
+}
+
+#endif
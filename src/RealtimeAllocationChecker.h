@@ -0,0 +1,36 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ * Test check that the realtime audio callback never touches the heap or blocks on a lock.
+ *
+ * Handles:
+ * - Marking the realtime part of processBlock() on the calling thread
+ * - Counting, and asserting on, every operator new / delete made inside it
+ * - On Linux (glibc) and macOS, the same for malloc, calloc, realloc, free, the aligned
+ *   allocations and pthread_mutex_lock; on Windows only operator new / delete are checked
+ *
+ * Only active when KINGSCAB_CHECK_REALTIME_ALLOCATIONS is set, which only the KingsCabTests
+ * console app does. In the plugin the scope is an empty object, and the allocator and locks
+ * are left to the host.
+ */
+class RealtimeAllocationChecker
+{
+public:
+    //==============================================================================
+    class ScopedAudioCallback
+    {
+    public:
+        ScopedAudioCallback() noexcept;
+        ~ScopedAudioCallback() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedAudioCallback)
+    };
+
+    // Heap operations and blocking locks caught inside a ScopedAudioCallback since the plugin was loaded
+    static int getNumViolations() noexcept;
+
+    RealtimeAllocationChecker() = delete;
+};
@@ -0,0 +1,231 @@
+#include <JuceHeader.h>
+#include "DSP/ConvolutionEngine.h"
+#include "DSP/PartitionedConvolver.h"
+#include "TestSignals.h"
+#include <array>
+
+//==============================================================================
+/**
+ * Null tests for the convolution paths.
+ *
+ * Covers:
+ * - Every processing mode against juce::dsp::Convolution, at small, large, odd and
+ *   variable host block sizes, with two slots weighted against each other
+ * - Muting a slot, playing on, then unmuting it: nothing it was fed while muted is heard,
+ *   in any mode
+ * - The uniform and non-uniform PartitionedConvolver layouts against each other,
+ *   with the late tail on the background worker
+ */
+class ConvolutionNullTests : public juce::UnitTest
+{
+public:
+    ConvolutionNullTests() : juce::UnitTest("Convolution null tests", "KingsCab") {}
+
+    void runTest() override
+    {
+        using Mode = ConvolutionEngine::ProcessingMode;
+
+        for (auto mode : { Mode::perSlot, Mode::sharedSpectrum, Mode::zeroLatency })
+        {
+            for (int blockSize : { 32, 256, 1000 })
+            {
+                beginTest(getModeName(mode) + " nulls against juce::dsp::Convolution, "
+                          + juce::String(blockSize) + "-sample blocks");
+                expectNullAgainstJuceConvolution(mode, blockSize, false);
+            }
+
+            beginTest(getModeName(mode) + " nulls against juce::dsp::Convolution, variable blocks");
+            expectNullAgainstJuceConvolution(mode, 512, true);
+
+            beginTest(getModeName(mode) + " nulls through a mute, play and unmute");
+            expectNullThroughMute(mode, 256);
+        }
+
+        for (int blockSize : { 64, 512 })
+        {
+            beginTest("Uniform and non-uniform layouts agree, " + juce::String(blockSize) + "-sample blocks");
+            expectLayoutsAgree(blockSize);
+        }
+    }
+
+private:
+    //==============================================================================
+    static juce::String getModeName(ConvolutionEngine::ProcessingMode mode)
+    {
+        switch (mode)
+        {
+            case ConvolutionEngine::ProcessingMode::perSlot:        return "Per-slot mode";
+            case ConvolutionEngine::ProcessingMode::sharedSpectrum: return "Shared-spectrum mode";
+            case ConvolutionEngine::ProcessingMode::zeroLatency:    return "Zero-latency mode";
+        }
+
+        return {};
+    }
+
+    template <typename Processor>
+    static void processRange(Processor& processor, juce::AudioBuffer<float>& buffer, int start, int numSamples)
+    {
+        auto block = juce::dsp::AudioBlock<float>(buffer).getSubBlock(static_cast<size_t>(start),
+                                                                     static_cast<size_t>(numSamples));
+        juce::dsp::ProcessContextReplacing<float> context(block);
+        processor.process(context);
+    }
+
+    static void loadReference(juce::dsp::Convolution& convolution, const juce::AudioBuffer<float>& ir, int blockSize)
+    {
+        // Loaded before prepare(), the IR is in place from the first block, with no fade-in
+        juce::AudioBuffer<float> irCopy(ir);
+        convolution.loadImpulseResponse(std::move(irCopy), kSampleRate,
+                                        juce::dsp::Convolution::Stereo::yes,
+                                        juce::dsp::Convolution::Trim::yes,
+                                        juce::dsp::Convolution::Normalise::yes);
+        convolution.prepare({ kSampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(kNumChannels) });
+    }
+
+    //==============================================================================
+    void expectNullAgainstJuceConvolution(ConvolutionEngine::ProcessingMode mode, int blockSize, bool variableBlocks)
+    {
+        ConvolutionEngine engine(kNumSlots, kMaxIRLength);
+        engine.setProcessingMode(mode);
+        engine.prepare({ kSampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(kNumChannels) });
+
+        // Short enough that no stage goes to the tail worker, so the result can't depend on timing
+        const auto cabinet = TestSignals::makeImpulseResponse(kNumChannels, 2000, 400.0f, 1);
+        const auto room = TestSignals::makeImpulseResponse(kNumChannels, 700, 120.0f, 2);
+        expect(engine.loadImpulseResponse(0, cabinet));
+        expect(engine.loadImpulseResponse(2, room));
+        engine.setSlotGain(2, 0.5f);
+        engine.setSlotPhaseInvert(2, true);
+
+        juce::dsp::Convolution cabinetReference, roomReference;
+        loadReference(cabinetReference, cabinet, blockSize);
+        loadReference(roomReference, room, blockSize);
+
+        const auto input = TestSignals::makeNoise(kNumChannels, kNumSamples, 3);
+        juce::AudioBuffer<float> output(input), cabinetOutput(input), roomOutput(input);
+        juce::Random blockSizes(4);
+
+        for (int start = 0; start < kNumSamples;)
+        {
+            const auto numSamples = juce::jmin(variableBlocks ? 1 + blockSizes.nextInt(blockSize) : blockSize,
+                                               kNumSamples - start);
+            processRange(engine, output, start, numSamples);
+            processRange(cabinetReference, cabinetOutput, start, numSamples);
+            processRange(roomReference, roomOutput, start, numSamples);
+            start += numSamples;
+        }
+
+        // Slot gain and phase scale each IR's output, whichever path convolved it
+        for (int ch = 0; ch < kNumChannels; ++ch)
+            cabinetOutput.addFrom(ch, 0, roomOutput, ch, 0, kNumSamples, -0.5f);
+
+        expectLessThan(TestSignals::getMaxDifference(output, cabinetOutput, kSettleSamples), kTolerance);
+    }
+
+    void expectNullThroughMute(ConvolutionEngine::ProcessingMode mode, int blockSize)
+    {
+        ConvolutionEngine engine(kNumSlots, kMaxIRLength);
+        engine.setProcessingMode(mode);
+        engine.prepare({ kSampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(kNumChannels) });
+
+        const auto cabinet = TestSignals::makeImpulseResponse(kNumChannels, 2000, 400.0f, 1);
+        const auto room = TestSignals::makeImpulseResponse(kNumChannels, 700, 120.0f, 2);
+        expect(engine.loadImpulseResponse(0, cabinet));
+        expect(engine.loadImpulseResponse(2, room));
+        engine.setSlotGain(2, 0.5f);
+
+        juce::dsp::Convolution cabinetReference, roomReference;
+        loadReference(cabinetReference, cabinet, blockSize);
+        loadReference(roomReference, room, blockSize);
+
+        // The room is muted long enough to go to sleep, and unmuted straight after input it must
+        // not hear. The mute and unmute ramps only meet silence, so every mode gives the same output
+        constexpr int muteAt = 12000, unmuteAt = 30000, quietSamples = 2500;
+        auto input = TestSignals::makeNoise(kNumChannels, kNumSamples, 7);
+
+        for (int ch = 0; ch < kNumChannels; ++ch)
+        {
+            input.clear(ch, muteAt - quietSamples, 2 * quietSamples);
+            input.clear(ch, unmuteAt, quietSamples);
+        }
+
+        juce::AudioBuffer<float> output(input), cabinetOutput(input), roomOutput(input);
+        for (int ch = 0; ch < kNumChannels; ++ch)
+            roomOutput.clear(ch, muteAt, unmuteAt - muteAt);
+
+        for (int start = 0; start < kNumSamples; start += blockSize)
+        {
+            const auto numSamples = juce::jmin(blockSize, kNumSamples - start);
+            engine.setSlotMute(2, start >= muteAt && start < unmuteAt);
+            processRange(engine, output, start, numSamples);
+            processRange(cabinetReference, cabinetOutput, start, numSamples);
+            processRange(roomReference, roomOutput, start, numSamples);
+        }
+
+        for (int ch = 0; ch < kNumChannels; ++ch)
+            cabinetOutput.addFrom(ch, 0, roomOutput, ch, 0, kNumSamples, 0.5f);
+
+        expectLessThan(TestSignals::getMaxDifference(output, cabinetOutput, kSettleSamples), kTolerance);
+    }
+
+    void expectLayoutsAgree(int blockSize)
+    {
+        // Long enough for the non-uniform layout to hand its late stages to the worker
+        const auto ir = TestSignals::makeImpulseResponse(kNumChannels, 20000, 3000.0f, 5);
+
+        PartitionedConvolver uniform, nonUniform;
+        uniform.prepare(blockSize, kNumChannels, ir.getNumSamples(), 1, PartitionedConvolver::Layout::uniform);
+
+        // Faster than realtime, so late tail blocks are waited for, as in an offline render
+        nonUniform.setUseBackgroundThread(true);
+        nonUniform.setWaitForLateJobs(true);
+        nonUniform.prepare(blockSize, kNumChannels, ir.getNumSamples(), 1, PartitionedConvolver::Layout::nonUniform);
+
+        const auto uniformKernel = uniform.createKernel(ir);
+        const auto nonUniformKernel = nonUniform.createKernel(ir);
+        uniform.setKernel(0, uniformKernel.get());
+        nonUniform.setKernel(0, nonUniformKernel.get());
+
+        const auto input = TestSignals::makeNoise(kNumChannels, kNumSamples, 6);
+        juce::AudioBuffer<float> uniformOutput(kNumChannels, kNumSamples);
+        juce::AudioBuffer<float> nonUniformOutput(kNumChannels, kNumSamples);
+        const float weight = 1.0f;
+
+        std::array<const float*, kNumChannels> inputs{};
+        std::array<float*, kNumChannels> uniformOutputs{};
+        std::array<float*, kNumChannels> nonUniformOutputs{};
+
+        for (int start = 0; start < kNumSamples; start += blockSize)
+        {
+            const auto numSamples = juce::jmin(blockSize, kNumSamples - start);
+
+            for (int ch = 0; ch < kNumChannels; ++ch)
+            {
+                inputs[static_cast<size_t>(ch)] = input.getReadPointer(ch, start);
+                uniformOutputs[static_cast<size_t>(ch)] = uniformOutput.getWritePointer(ch, start);
+                nonUniformOutputs[static_cast<size_t>(ch)] = nonUniformOutput.getWritePointer(ch, start);
+            }
+
+            uniform.process(inputs.data(), uniformOutputs.data(), kNumChannels, numSamples, &weight);
+            nonUniform.process(inputs.data(), nonUniformOutputs.data(), kNumChannels, numSamples, &weight);
+        }
+
+        // The worker may still be reading the kernel until it has stopped
+        nonUniform.stopBackgroundThread();
+
+        expectEquals(nonUniform.getNumMissedDeadlines(), 0);
+        expectLessThan(TestSignals::getMaxDifference(uniformOutput, nonUniformOutput, 0),
+                       kTolerance * uniformOutput.getMagnitude(0, kNumSamples));
+    }
+
+    //==============================================================================
+    static constexpr double kSampleRate = 48000.0;
+    static constexpr int kNumChannels = 2;
+    static constexpr int kNumSlots = 6;
+    static constexpr int kMaxIRLength = 48000;
+    static constexpr int kNumSamples = 48000;
+    static constexpr int kSettleSamples = 9600;     // gain ramps and the IR fade-in are over by then
+    static constexpr float kTolerance = 1.0e-4f;    // float FFT round-off, well below -80 dB
+};
+
+static ConvolutionNullTests convolutionNullTests;
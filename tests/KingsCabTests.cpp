@@ -0,0 +1,19 @@
+#include <JuceHeader.h>
+
+//==============================================================================
+// Runs every juce::UnitTest linked into this app; any failure makes ctest fail
+int main()
+{
+    // The IR loader reports back through the message thread, so one has to exist
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runAllTests();
+
+    int numFailures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult(i)->failures;
+
+    return numFailures > 0 ? 1 : 0;
+}
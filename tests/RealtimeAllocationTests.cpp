@@ -0,0 +1,141 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "RealtimeAllocationChecker.h"
+#include "TestSignals.h"
+#include <array>
+
+//==============================================================================
+/**
+ * Drives processBlock() through a busy session and fails on any heap use or blocking lock inside it.
+ *
+ * Covers, in every processing mode:
+ * - IR swaps and clears in every slot, from direct-form FIRs to IRs long enough for the tail worker
+ * - Mute, solo and phase toggles, and gain moves that keep the composite IR being rebuilt
+ * - Host block sizes that vary from block to block, and re-prepares at new maximum sizes
+ * - Offline render switches, signalled from the audio thread the way some hosts do
+ */
+class RealtimeAllocationTests : public juce::UnitTest
+{
+public:
+    RealtimeAllocationTests() : juce::UnitTest("Realtime allocations", "KingsCab") {}
+
+    void runTest() override
+    {
+        using Mode = ConvolutionEngine::ProcessingMode;
+
+        // Lengths on either side of the direct-form limit and of the first background stage
+        for (int i = 0; i < static_cast<int>(impulseResponses.size()); ++i)
+            impulseResponses[static_cast<size_t>(i)] = TestSignals::makeImpulseResponse(
+                i % 2 == 0 ? 2 : 1, kIRLengths[static_cast<size_t>(i)], static_cast<float>(kIRLengths[static_cast<size_t>(i)]) / 6.0f, i + 1);
+
+        for (auto mode : { Mode::zeroLatency, Mode::sharedSpectrum, Mode::perSlot })
+        {
+            beginTest(juce::String("processBlock() never allocates or locks, ")
+                      + (mode == Mode::perSlot ? "per-slot" : mode == Mode::sharedSpectrum ? "shared-spectrum" : "zero-latency")
+                      + " mode");
+            runSession(mode);
+        }
+    }
+
+private:
+    //==============================================================================
+    void runSession(ConvolutionEngine::ProcessingMode mode)
+    {
+        TheKingsCabAudioProcessor processor;
+        auto& engine = processor.getConvolutionEngine();
+        auto& parameters = processor.getValueTreeState();
+        juce::Random random(static_cast<juce::int64>(mode) + 1);
+
+        engine.setProcessingMode(mode);
+
+        // Per-slot mode spreads slots over the worker pool at every block size
+        if (mode == ConvolutionEngine::ProcessingMode::perSlot)
+            engine.setParallelSlotThreshold(0);
+
+        int maximumBlockSize = kMaximumBlockSizes[0];
+        processor.prepareToPlay(kSampleRate, maximumBlockSize);
+
+        for (int slot = 0; slot < TheKingsCabAudioProcessor::kNumIRSlots; ++slot)
+            engine.loadImpulseResponse(slot, impulseResponses[static_cast<size_t>(slot)]);
+
+        const auto input = TestSignals::makeNoise(2, kMaximumBlockSizes.back(), 7);
+        juce::AudioBuffer<float> buffer(2, kMaximumBlockSizes.back());
+        juce::MidiBuffer midi;
+        bool renderingOffline = false;
+        const auto violationsBefore = RealtimeAllocationChecker::getNumViolations();
+
+        for (int blockIndex = 0; blockIndex < kNumBlocks; ++blockIndex)
+        {
+            // The message and loader threads' side of the session; none of it is checked
+            if (blockIndex % 200 == 199)
+            {
+                processor.releaseResources();
+                maximumBlockSize = kMaximumBlockSizes[static_cast<size_t>(random.nextInt(static_cast<int>(kMaximumBlockSizes.size())))];
+                processor.prepareToPlay(kSampleRate, maximumBlockSize);
+            }
+
+            if (blockIndex % 40 == 13)
+            {
+                const auto slot = random.nextInt(TheKingsCabAudioProcessor::kNumIRSlots);
+
+                if (random.nextInt(5) == 0)
+                    engine.clearImpulseResponse(slot);
+                else
+                    engine.loadImpulseResponse(slot, impulseResponses[static_cast<size_t>(random.nextInt(static_cast<int>(impulseResponses.size())))]);
+            }
+
+            if (blockIndex % 25 == 7)
+                toggleParameter(parameters, "slot" + juce::String(random.nextInt(TheKingsCabAudioProcessor::kNumIRSlots))
+                                            + (random.nextBool() ? "_mute" : random.nextBool() ? "_solo" : "_phase"));
+
+            if (blockIndex % 60 == 31)
+                setParameter(parameters, "slot" + juce::String(random.nextInt(TheKingsCabAudioProcessor::kNumIRSlots)) + "_gain",
+                             random.nextFloat());
+
+            // Background threads (composite builder, reclaimer, tail worker) get to run in between
+            if (blockIndex % 8 == 0)
+                juce::Thread::sleep(1);
+
+            const auto numSamples = 1 + random.nextInt(maximumBlockSize);
+            buffer.setSize(2, numSamples, false, false, true);
+
+            for (int ch = 0; ch < 2; ++ch)
+                buffer.copyFrom(ch, 0, input, ch, 0, numSamples);
+
+            {
+                // Some hosts flag offline renders from the audio thread, once per block
+                const RealtimeAllocationChecker::ScopedAudioCallback realtimeScope;
+                if (blockIndex % 500 == 250)
+                    renderingOffline = !renderingOffline;
+
+                processor.setNonRealtime(renderingOffline);
+            }
+
+            processor.processBlock(buffer, midi);
+        }
+
+        expectEquals(RealtimeAllocationChecker::getNumViolations() - violationsBefore, 0);
+    }
+
+    static void setParameter(juce::AudioProcessorValueTreeState& parameters, const juce::String& parameterID, float normalisedValue)
+    {
+        if (auto* parameter = parameters.getParameter(parameterID))
+            parameter->setValueNotifyingHost(normalisedValue);
+    }
+
+    static void toggleParameter(juce::AudioProcessorValueTreeState& parameters, const juce::String& parameterID)
+    {
+        if (auto* parameter = parameters.getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->getValue() > 0.5f ? 0.0f : 1.0f);
+    }
+
+    //==============================================================================
+    static constexpr double kSampleRate = 48000.0;
+    static constexpr int kNumBlocks = 3000;
+    static constexpr std::array<int, 4> kMaximumBlockSizes{ 64, 256, 512, 1024 };
+    static constexpr std::array<int, 6> kIRLengths{ 200, 1500, 2048, 6000, 24000, 96000 };
+
+    std::array<juce::AudioBuffer<float>, 6> impulseResponses;
+};
+
+static RealtimeAllocationTests realtimeAllocationTests;
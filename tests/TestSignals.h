@@ -0,0 +1,52 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Deterministic test signals shared by the KingsCabTests suites. */
+namespace TestSignals
+{
+    /** White noise in [-amplitude, amplitude], a different sequence on every channel. */
+    inline juce::AudioBuffer<float> makeNoise(int numChannels, int numSamples, juce::int64 seed, float amplitude = 0.5f)
+    {
+        juce::Random random(seed);
+        juce::AudioBuffer<float> noise(numChannels, numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                noise.setSample(ch, i, amplitude * (random.nextFloat() * 2.0f - 1.0f));
+
+        return noise;
+    }
+
+    /**
+     * A cabinet-like IR: a unit first tap (so trimming never moves it), then exponentially
+     * decaying noise. Every channel differs, so the stereo paths are really exercised.
+     */
+    inline juce::AudioBuffer<float> makeImpulseResponse(int numChannels, int numSamples, float decaySamples, juce::int64 seed)
+    {
+        auto ir = makeNoise(numChannels, numSamples, seed, 1.0f);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            ir.setSample(ch, 0, 1.0f);
+
+            for (int i = 1; i < numSamples; ++i)
+                ir.setSample(ch, i, ir.getSample(ch, i) * std::exp(-static_cast<float>(i) / decaySamples));
+        }
+
+        return ir;
+    }
+
+    /** Largest sample difference between two buffers, from startSample on. */
+    inline float getMaxDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b, int startSample)
+    {
+        float maxDifference = 0.0f;
+
+        for (int ch = 0; ch < juce::jmin(a.getNumChannels(), b.getNumChannels()); ++ch)
+            for (int i = startSample; i < juce::jmin(a.getNumSamples(), b.getNumSamples()); ++i)
+                maxDifference = juce::jmax(maxDifference, std::abs(a.getSample(ch, i) - b.getSample(ch, i)));
+
+        return maxDifference;
+    }
+}